@@ -22,7 +22,8 @@ export const State = {
 export const TextMeasurementMode = {
     FAST: 'fast',
     ACCURATE: 'accurate',
-    PIXEL_PERFECT: 'pixel-perfect'
+    PIXEL_PERFECT: 'pixel-perfect',
+    HYBRID: 'hybrid'
 };
 
 /**
@@ -73,7 +74,7 @@ export class Lotio extends EventEmitter {
      * @param {Object|string} options.animation - Lottie animation JSON (object or string)
      * @param {Object|string} options.layerOverrides - Layer overrides JSON (object or string) for text and image overrides
      * @param {number} options.textPadding - Text padding factor (0.0-1.0, default: 0.97)
-     * @param {string} options.textMeasurementMode - Text measurement mode: 'fast'|'accurate'|'pixel-perfect' (default: 'accurate')
+     * @param {string} options.textMeasurementMode - Text measurement mode: 'fast'|'accurate'|'pixel-perfect'|'hybrid' (default: 'accurate')
      * @param {string} options.wasmPath - Path to lotio.wasm file (default: './lotio.wasm')
      */
     constructor(options = {}) {
@@ -161,7 +161,7 @@ export function createAnimation(jsonData, layerOverrides = null, textPadding = 0
     const jsonStr = typeof jsonData === 'string' ? jsonData : JSON.stringify(jsonData);
     const layerOverridesStr = layerOverrides ? (typeof layerOverrides === 'string' ? layerOverrides : JSON.stringify(layerOverrides)) : null;
     
-    // Convert textMeasurementMode string to integer (0=FAST, 1=ACCURATE, 2=PIXEL_PERFECT)
+    // Convert textMeasurementMode string to integer (0=FAST, 1=ACCURATE, 2=PIXEL_PERFECT, 3=HYBRID)
     const modeStr = String(textMeasurementMode).toLowerCase();
     let modeInt = 1; // Default to ACCURATE
     if (modeStr === 'fast') {
@@ -170,6 +170,8 @@ export function createAnimation(jsonData, layerOverrides = null, textPadding = 0
         modeInt = 1;
     } else if (modeStr === 'pixel-perfect' || modeStr === 'pixelperfect') {
         modeInt = 2;
+    } else if (modeStr === 'hybrid') {
+        modeInt = 3;
     }
     
     // Allocate memory using exported _malloc
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <lotio/text/font_service.h>
+#include <lotio/text/font_utils.h>
+#include <lotio/text/text_sizing.h>
+
+// Benchmark: font-size fitting with solveFittingFontSize() against the binary search it replaced
+// For a range of target widths, both fit the text between minSize and maxSize starting from a
+// measured size (as calculateOptimalFontSize() does) and the number of measurements, the time and
+// the difference of the fitted sizes are reported. Every solver result is checked to fit.
+// Build: g++ -O2 $(pkg-config --cflags --libs lotio) bench_font_size_solver.cpp -o bench_font_size_solver
+// Usage: bench_font_size_solver [family] [style] [fontName] [mode: fast|accurate|pixel-perfect]
+
+int main(int argc, char* argv[]) {
+    std::string family = (argc > 1) ? argv[1] : "DejaVu Sans";
+    std::string style = (argc > 2) ? argv[2] : "Bold";
+    std::string fontName = (argc > 3) ? argv[3] : "DejaVuSans-Bold";
+    std::string modeName = (argc > 4) ? argv[4] : "accurate";
+    TextMeasurementMode mode = TextMeasurementMode::ACCURATE;
+    if (modeName == "fast") {
+        mode = TextMeasurementMode::FAST;
+    } else if (modeName == "pixel-perfect") {
+        mode = TextMeasurementMode::PIXEL_PERFECT;
+    } else if (modeName != "accurate") {
+        std::cerr << "Usage: " << argv[0] << " [family] [style] [fontName] [fast|accurate|pixel-perfect]" << std::endl;
+        return 1;
+    }
+
+    sk_sp<SkFontMgr> fontMgr = sharedFontManager();
+    if (!fontMgr) {
+        std::cerr << "Failed to create font manager" << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> texts = {"Hi", "Weekly Sale", "The quick brown fox jumps over the lazy dog"};
+    const float startSize = 48.0f;
+    const float minSize = 8.0f;
+    const float maxSize = 200.0f;
+
+    int measurements = 0;
+    auto measureAtSize = [&](const std::string& text, float size) {
+        measurements++;
+        return measureTextWidth(fontMgr.get(), family, style, fontName, size, text, mode);
+    };
+
+    // Reference: the binary search calculateOptimalFontSize() used before the solver
+    auto binarySearch = [&](const std::string& text, float currentWidth, float targetWidth) {
+        bool grow = currentWidth <= targetWidth;
+        float min = grow ? startSize : minSize;
+        float max = grow ? maxSize : startSize;
+        float bestSize = min;
+        for (int i = 0; i < (grow ? 10 : 15); i++) {
+            float testSize = (min + max) / 2.0f;
+            if (measureAtSize(text, testSize) <= targetWidth) {
+                bestSize = testSize;
+                min = testSize;
+            } else {
+                max = testSize;
+            }
+            if (!grow && (max - min) < 0.1f) {
+                break;
+            }
+        }
+        return std::min(bestSize, maxSize);
+    };
+
+    auto solver = [&](const std::string& text, float currentWidth, float targetWidth) {
+        if (currentWidth <= targetWidth) {
+            return solveFittingFontSize([&](float size) { return measureAtSize(text, size); },
+                                        startSize, currentWidth, maxSize, targetWidth);
+        }
+        float minWidth = measureAtSize(text, minSize);
+        return solveFittingFontSize([&](float size) { return measureAtSize(text, size); },
+                                    minSize, minWidth, startSize, targetWidth, startSize, currentWidth);
+    };
+
+    using Clock = std::chrono::steady_clock;
+    int cases = 0;
+    int binaryMeasurements = 0;
+    int solverMeasurements = 0;
+    double binaryUs = 0.0;
+    double solverUs = 0.0;
+    double maxDiff = 0.0;
+    double sumDiff = 0.0;
+    int violations = 0;
+
+    for (const std::string& text : texts) {
+        float currentWidth = measureTextWidth(fontMgr.get(), family, style, fontName, startSize, text, mode);
+        float minWidth = measureTextWidth(fontMgr.get(), family, style, fontName, minSize, text, mode);
+        for (float scale = 0.2f; scale <= 3.0f; scale += 0.05f) {
+            float targetWidth = currentWidth * scale;
+            if (targetWidth < minWidth) {
+                continue;  // calculateOptimalFontSize() falls back to other text here
+            }
+
+            measurements = 0;
+            auto start = Clock::now();
+            float binarySize = binarySearch(text, currentWidth, targetWidth);
+            binaryUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            binaryMeasurements += measurements;
+
+            measurements = 0;
+            start = Clock::now();
+            float solverSize = solver(text, currentWidth, targetWidth);
+            solverUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            solverMeasurements += measurements;
+
+            if (measureTextWidth(fontMgr.get(), family, style, fontName, solverSize, text, mode) > targetWidth) {
+                violations++;
+            }
+            double diff = std::fabs(static_cast<double>(solverSize) - binarySize);
+            sumDiff += diff;
+            maxDiff = std::max(maxDiff, diff);
+            cases++;
+        }
+    }
+
+    if (cases == 0) {
+        std::cerr << "No target widths to fit" << std::endl;
+        return 1;
+    }
+    std::cout << "Font: " << family << " " << style << " (" << fontName << "), mode " << modeName
+              << ", " << cases << " fits" << std::endl;
+    std::cout << "Binary search: " << (static_cast<double>(binaryMeasurements) / cases) << " measurements, "
+              << (binaryUs / cases) << " us per fit" << std::endl;
+    std::cout << "Solver:        " << (static_cast<double>(solverMeasurements) / cases) << " measurements, "
+              << (solverUs / cases) << " us per fit" << std::endl;
+    std::cout << "Size difference: mean " << (sumDiff / cases) << " pt, max " << maxDiff << " pt; "
+              << violations << " solver results too wide" << std::endl;
+    return violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <lotio/text/font_service.h>
+#include <lotio/text/font_utils.h>
+#include <skia/core/SkFontMgr.h>
+#include <skia/ports/SkFontMgr_fontconfig.h>
+#include <skia/ports/SkFontScanner_FreeType.h>
+
+// Benchmark: per-measurement cost of text measurement with and without typeface memoization
+// "Uncached" measures against a second fontconfig font manager, which resolveTypeface() queries
+// directly on every call (family + style, full name, legacy fallback), as every measurement did
+// before the resolver cache. "Cached" measures against the shared font manager.
+// Build: g++ -O2 $(pkg-config --cflags --libs lotio) bench_text_measure.cpp -o bench_text_measure
+// Usage: bench_text_measure [family] [style] [fontName] [iterations]
+
+int main(int argc, char* argv[]) {
+    std::string family = (argc > 1) ? argv[1] : "DejaVu Sans";
+    std::string style = (argc > 2) ? argv[2] : "Bold";
+    std::string fontName = (argc > 3) ? argv[3] : "DejaVuSans-Bold";
+    int iterations = (argc > 4) ? std::atoi(argv[4]) : 2000;
+    if (iterations <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [family] [style] [fontName] [iterations]" << std::endl;
+        return 1;
+    }
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+
+    sk_sp<SkFontMgr> uncachedMgr = SkFontMgr_New_FontConfig(nullptr, SkFontScanner_Make_FreeType());
+    sk_sp<SkFontMgr> cachedMgr = sharedFontManager();
+    if (!uncachedMgr || !cachedMgr) {
+        std::cerr << "Failed to create font managers" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Font: " << family << " " << style << " (" << fontName << "), " << iterations << " iterations" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto perCallUs = [](Clock::time_point start, int count) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+    };
+
+    // Typeface resolution alone
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        resolveTypeface(uncachedMgr.get(), family, style, fontName);
+    }
+    double uncachedResolveUs = perCallUs(start, iterations);
+
+    resolveTypeface(cachedMgr.get(), family, style, fontName);  // First resolution fills the cache
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        resolveTypeface(cachedMgr.get(), family, style, fontName);
+    }
+    double cachedResolveUs = perCallUs(start, iterations);
+
+    std::cout << "resolveTypeface: uncached " << uncachedResolveUs << " us, cached " << cachedResolveUs << " us";
+    if (cachedResolveUs > 0.0) {
+        std::cout << " (" << (uncachedResolveUs / cachedResolveUs) << "x)";
+    }
+    std::cout << std::endl;
+
+    // Full measurements at the sizes a font-size search visits
+    for (TextMeasurementMode mode : {TextMeasurementMode::FAST, TextMeasurementMode::ACCURATE,
+                                     TextMeasurementMode::PIXEL_PERFECT}) {
+        const char* modeName = (mode == TextMeasurementMode::FAST) ? "fast" :
+                               (mode == TextMeasurementMode::ACCURATE) ? "accurate" : "pixel-perfect";
+        start = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            measureTextWidth(uncachedMgr.get(), family, style, fontName, 10.0f + (i % 100), text, mode);
+        }
+        double uncachedUs = perCallUs(start, iterations);
+
+        start = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            measureTextWidth(cachedMgr.get(), family, style, fontName, 10.0f + (i % 100), text, mode);
+        }
+        double cachedUs = perCallUs(start, iterations);
+
+        std::cout << "measureTextWidth (" << modeName << "): uncached " << uncachedUs << " us, cached "
+                  << cachedUs << " us";
+        if (cachedUs > 0.0) {
+            std::cout << " (" << (uncachedUs / cachedUs) << "x)";
+        }
+        std::cout << std::endl;
+    }
+
+    const auto& resolver = sharedTypefaceResolver();
+    std::cout << "Shared resolver: " << resolver.hits() << " hits, " << resolver.misses() << " misses" << std::endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <lotio/core/pixel_convert.h>
+#include <skia/core/SkCanvas.h>
+#include <skia/core/SkImage.h>
+#include <skia/core/SkPixmap.h>
+#include <skia/core/SkSurface.h>
+
+// Benchmark: premultiplied -> unpremultiplied frame conversion
+// Compares the lotio conversion kernel with the Skia clear + drawImage path it replaces
+// Build: g++ -O2 $(pkg-config --cflags --libs lotio) bench_unpremultiply.cpp -o bench_unpremultiply
+
+int main(int argc, char* argv[]) {
+    int width = (argc > 1) ? std::atoi(argv[1]) : 1920;
+    int height = (argc > 2) ? std::atoi(argv[2]) : 1080;
+    int iterations = (argc > 3) ? std::atoi(argv[3]) : 100;
+    if (width <= 0 || height <= 0 || iterations <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [width] [height] [iterations]" << std::endl;
+        return 1;
+    }
+
+    // Synthetic premultiplied frame: a mix of transparent, opaque and translucent pixels
+    SkImageInfo premulInfo = SkImageInfo::MakeN32(width, height, kPremul_SkAlphaType);
+    size_t rowBytes = premulInfo.minRowBytes();
+    std::vector<uint8_t> premul(premulInfo.computeByteSize(rowBytes));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < premul.size(); i += 4) {
+        seed = seed * 1664525u + 1013904223u;
+        uint8_t a = static_cast<uint8_t>(seed >> 24);
+        if ((seed & 3) == 0) a = 0;
+        if ((seed & 3) == 1) a = 255;
+        for (int c = 0; c < 3; c++) {
+            premul[i + c] = static_cast<uint8_t>(((seed >> (c * 8)) & 0xFF) * a / 255);
+        }
+        premul[i + 3] = a;
+    }
+    sk_sp<SkImage> image = SkImages::RasterFromPixmap(SkPixmap(premulInfo, premul.data(), rowBytes),
+                                                      nullptr, nullptr);
+
+    SkImageInfo unpremulInfo = SkImageInfo::MakeN32(width, height, kUnpremul_SkAlphaType);
+    auto surface = SkSurfaces::Raster(unpremulInfo);
+    std::vector<uint8_t> output(premul.size());
+    if (!image || !surface) {
+        std::cerr << "Failed to create benchmark images" << std::endl;
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+        surface->getCanvas()->drawImage(image, 0, 0, SkSamplingOptions());
+        sk_sp<SkImage> converted = surface->makeImageSnapshot();
+    }
+    double skiaMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        unpremultiplyPixels(premul.data(), rowBytes, output.data(), rowBytes, width, height, false);
+    }
+    double kernelMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+
+    std::cout << "Frame: " << width << "x" << height << ", " << iterations << " iterations" << std::endl;
+    std::cout << "Skia clear + drawImage: " << skiaMs << " ms/frame" << std::endl;
+    std::cout << "Kernel (" << unpremultiplyKernelName() << "): " << kernelMs << " ms/frame" << std::endl;
+    if (kernelMs > 0.0) {
+        std::cout << "Speedup: " << (skiaMs / kernelMs) << "x" << std::endl;
+    }
+    return 0;
+}
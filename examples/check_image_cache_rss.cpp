@@ -0,0 +1,148 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include <lotio/core/animation_setup.h>
+#include <skia/core/SkCanvas.h>
+#include <skia/core/SkColor.h>
+#include <skia/core/SkData.h>
+#include <skia/core/SkImage.h>
+#include <skia/core/SkPaint.h>
+#include <skia/core/SkSurface.h>
+#include <skia/encode/SkPngEncoder.h>
+
+// Memory check: resident set size across a long slideshow rendered with a small image cache
+// Generates a slideshow of distinct photos (one image layer per second), renders it with the image
+// cache budget of --image-cache-mb and samples the process RSS after every frame. The growth over
+// the RSS before the first frame must stay within the decoded bytes the cache reports resident
+// (plus one image and allocator slack): pixels the cache no longer accounts for must be freed.
+// Build: g++ -O2 $(pkg-config --cflags --libs lotio) check_image_cache_rss.cpp -o check_image_cache_rss
+// Usage: check_image_cache_rss [images] [image size] [image-cache-mb] [fps]   (default: 120 1024 32 10)
+
+namespace fs = std::filesystem;
+
+// Current resident set size in bytes (VmRSS from /proc/self/status; 0 when unavailable)
+static size_t residentSetBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return static_cast<size_t>(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Write a size x size PNG whose pixels differ per index (so every decode is a distinct image)
+static bool writeImage(const fs::path& path, int index, int size) {
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(size, size));
+    if (!surface) {
+        return false;
+    }
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SkColorSetRGB(index * 37 % 256, index * 91 % 256, index * 53 % 256));
+    SkPaint paint;
+    paint.setColor(SK_ColorWHITE);
+    canvas->drawCircle(size * 0.5f, size * 0.5f, size * (0.1f + (index % 8) * 0.05f), paint);
+    sk_sp<SkImage> image = surface->makeImageSnapshot();
+    sk_sp<SkData> png = SkPngEncoder::Encode(nullptr, image.get(), {});
+    if (!png) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(static_cast<const char*>(png->data()), static_cast<std::streamsize>(png->size()));
+    return file.good();
+}
+
+// Slideshow: image i is shown from second i to second i + 1
+static nlohmann::json slideshow(int images, int size, int fr) {
+    nlohmann::json animation = {
+        {"v", "5.7.0"}, {"fr", fr}, {"ip", 0}, {"op", images * fr}, {"w", size}, {"h", size},
+        {"assets", nlohmann::json::array()}, {"layers", nlohmann::json::array()}
+    };
+    const nlohmann::json transform = {
+        {"o", {{"a", 0}, {"k", 100}}}, {"r", {{"a", 0}, {"k", 0}}}, {"p", {{"a", 0}, {"k", {0, 0, 0}}}},
+        {"a", {{"a", 0}, {"k", {0, 0, 0}}}}, {"s", {{"a", 0}, {"k", {100, 100, 100}}}}
+    };
+    for (int i = 0; i < images; i++) {
+        const std::string id = "image_" + std::to_string(i);
+        animation["assets"].push_back({
+            {"id", id}, {"w", size}, {"h", size}, {"u", "images/"}, {"p", id + ".png"}, {"e", 0}
+        });
+        animation["layers"].push_back({
+            {"ty", 2}, {"ind", i + 1}, {"nm", id}, {"refId", id}, {"ip", i * fr}, {"op", (i + 1) * fr},
+            {"st", 0}, {"ks", transform}
+        });
+    }
+    return animation;
+}
+
+int main(int argc, char* argv[]) {
+    const int images = (argc > 1) ? std::atoi(argv[1]) : 120;
+    const int size = (argc > 2) ? std::atoi(argv[2]) : 1024;
+    const int budget_mb = (argc > 3) ? std::atoi(argv[3]) : 32;
+    const int fps = (argc > 4) ? std::atoi(argv[4]) : 10;
+    if (images <= 0 || size <= 0 || budget_mb <= 0 || fps <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [images] [image size] [image-cache-mb] [fps]" << std::endl;
+        return 1;
+    }
+
+    const fs::path dir = fs::temp_directory_path() / "lotio-check-image-cache-rss";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "images");
+    for (int i = 0; i < images; i++) {
+        if (!writeImage(dir / "images" / ("image_" + std::to_string(i) + ".png"), i, size)) {
+            std::cerr << "Failed to write test image " << i << std::endl;
+            return 1;
+        }
+    }
+    const fs::path input = dir / "slideshow.json";
+    std::ofstream(input) << slideshow(images, size, 30).dump();
+
+    const size_t budget = static_cast<size_t>(budget_mb) * 1024 * 1024;
+    AnimationSetupResult result = setupAndCreateAnimation(input.string(), "", 0.97f, TextMeasurementMode::ACCURATE,
+                                                          budget);
+    if (!result.success() || !result.image_cache) {
+        std::cerr << "Failed to load the slideshow with an image cache" << std::endl;
+        return 1;
+    }
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(size, size));
+    if (!surface) {
+        std::cerr << "Failed to create the render surface" << std::endl;
+        return 1;
+    }
+
+    const size_t image_bytes = static_cast<size_t>(size) * size * 4;
+    const size_t baseline = residentSetBytes();
+    size_t peak_growth = 0;
+    size_t peak_resident = 0;
+    const int frames = images * fps;
+    for (int frame = 0; frame < frames; frame++) {
+        const float t = static_cast<float>(frame) / fps;
+        result.image_cache->setPlayhead(t);
+        result.animation->seekFrameTime(t);
+        surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+        result.animation->render(surface->getCanvas());
+
+        const size_t rss = residentSetBytes();
+        peak_growth = std::max(peak_growth, rss > baseline ? rss - baseline : 0);
+        peak_resident = std::max(peak_resident, result.image_cache->residentBytes());
+    }
+    fs::remove_all(dir, ec);
+
+    const size_t slack = image_bytes + 16 * 1024 * 1024;
+    const bool accounted = peak_growth <= peak_resident + slack;
+    std::cout << frames << " frames, " << images << " images of " << (image_bytes / (1024 * 1024)) << " MB decoded ("
+              << (images * image_bytes / (1024 * 1024)) << " MB in total), budget " << budget_mb << " MB" << std::endl;
+    std::cout << "peak RSS growth:        " << (peak_growth / (1024 * 1024)) << " MB" << std::endl;
+    std::cout << "peak cache resident:    " << (peak_resident / (1024 * 1024)) << " MB"
+              << (peak_resident > budget ? " (over budget: images still referenced by the animation)" : "")
+              << std::endl;
+    std::cout << (accounted ? "OK       " : "FAIL     ")
+              << "RSS growth is within the cache's resident bytes plus one image and 16 MB" << std::endl;
+    return accounted ? 0 : 1;
+}
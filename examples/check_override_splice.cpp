@@ -0,0 +1,138 @@
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <lotio/text/font_service.h>
+#include <lotio/text/override_template.h>
+#include <lotio/text/text_processor.h>
+
+// Equivalence check: spliceLayerOverrides() against processLayerOverrides()
+// For every animation, the layer overrides are applied once by splicing into the compiled template
+// and once through the parsed document, and the two results must be the same JSON. Animations with
+// a layer-overrides.json next to them use it; the others get a generated one that overrides every
+// text layer the template records (longer text, so fitting and animator adjustments run) and points
+// every image asset whose file exists back at that file.
+// Build: g++ -O2 $(pkg-config --cflags --libs lotio) check_override_splice.cpp -o check_override_splice
+// Usage: check_override_splice [animation.json ...]   (default: examples/samples/*/data.json and examples/official/*.json)
+
+namespace fs = std::filesystem;
+
+static bool readFile(const fs::path& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// String value of a recorded JSON string range ("" if the range is empty or not a string)
+static std::string stringAt(const std::string& json, ByteRange range) {
+    if (range.empty()) {
+        return "";
+    }
+    nlohmann::json value = nlohmann::json::parse(json.substr(range.begin, range.end - range.begin), nullptr, false);
+    return value.is_string() ? value.get<std::string>() : "";
+}
+
+// Overrides for every text layer and existing image asset of the template
+static nlohmann::json generateOverrides(const OverrideTemplate& tmpl, const std::string& json,
+                                        const fs::path& animationDir) {
+    nlohmann::json overrides = nlohmann::json::object();
+    for (const auto& [name, layer] : tmpl.text_layers) {
+        overrides["textLayers"][name] = {
+            {"value", layer.font.text + " and some more text"},
+            {"fallbackText", "Fallback"},
+            {"minSize", 8},
+            {"maxSize", 200}
+        };
+    }
+    for (const auto& [id, asset] : tmpl.assets) {
+        const fs::path imageDir = animationDir / stringAt(json, asset.u);
+        if (!asset.has_p_string || asset.p_value.compare(0, 5, "data:") == 0 ||
+            !fs::is_regular_file(imageDir / asset.p_value)) {
+            continue;
+        }
+        overrides["imageLayers"][id] = {{"filePath", imageDir.string() + "/"}, {"fileName", asset.p_value}};
+    }
+    return overrides;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<fs::path> animations;
+    for (int i = 1; i < argc; i++) {
+        animations.emplace_back(argv[i]);
+    }
+    if (animations.empty()) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator("examples/samples", ec)) {
+            if (fs::is_regular_file(entry.path() / "data.json")) {
+                animations.push_back(entry.path() / "data.json");
+            }
+        }
+        for (const auto& entry : fs::directory_iterator("examples/official", ec)) {
+            if (entry.path().extension() == ".json") {
+                animations.push_back(entry.path());
+            }
+        }
+        std::sort(animations.begin(), animations.end());
+    }
+    if (animations.empty()) {
+        std::cerr << "No animations found (run from the repository root or pass animation files)" << std::endl;
+        return 1;
+    }
+
+    sk_sp<SkFontMgr> fontMgr = sharedFontManager();
+    const fs::path generatedOverrides = fs::temp_directory_path() / "lotio-check-override-splice.json";
+    int checked = 0;
+    int fallbacks = 0;
+    int mismatches = 0;
+    for (const auto& animation : animations) {
+        std::string json;
+        OverrideTemplate tmpl;
+        if (!readFile(animation, json) || !compileOverrideTemplate(json.data(), json.size(), tmpl)) {
+            std::cout << "SKIP     " << animation.string() << " (unreadable or malformed)" << std::endl;
+            continue;
+        }
+
+        fs::path overridesFile = animation.parent_path() / "layer-overrides.json";
+        if (!fs::is_regular_file(overridesFile)) {
+            nlohmann::json overrides = generateOverrides(tmpl, json, fs::absolute(animation).parent_path());
+            if (overrides.empty()) {
+                continue;  // Nothing to override
+            }
+            std::ofstream(generatedOverrides) << overrides.dump(2);
+            overridesFile = generatedOverrides;
+        }
+
+        std::string spliced;
+        if (!spliceLayerOverrides(tmpl, json.data(), json.size(), overridesFile.string(), spliced,
+                                  0.97f, TextMeasurementMode::ACCURATE, fontMgr.get())) {
+            std::cout << "FALLBACK " << animation.string() << " (template cannot splice these overrides)" << std::endl;
+            fallbacks++;
+            continue;
+        }
+        std::string parsed = json;
+        processLayerOverrides(parsed, overridesFile.string(), 0.97f, TextMeasurementMode::ACCURATE, fontMgr.get());
+
+        checked++;
+        if (nlohmann::json::parse(spliced) != nlohmann::json::parse(parsed)) {
+            std::cout << "MISMATCH " << animation.string() << std::endl;
+            mismatches++;
+        } else {
+            std::cout << "OK       " << animation.string() << std::endl;
+        }
+    }
+    std::error_code ec;
+    fs::remove(generatedOverrides, ec);
+
+    std::cout << checked << " animations compared, " << mismatches << " mismatches, " << fallbacks
+              << " parsed-document fallbacks" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -41,7 +41,7 @@ int main(int argc, char* argv[]) {
     int render_result = renderFrames(
         result.animation,
         result.builder,
-        result.processed_json,
+        *result.json_data,
         config
     );
 
@@ -323,8 +323,9 @@ if [[ "$TARGET" == "wasm" ]]; then
     fi
     
     # Fetch WASM dependencies
-    if [ ! -d "third_party/externals/freetype" ] || [ ! -d "third_party/externals/libpng" ] || [ ! -d "third_party/externals/brotli" ]; then
-        echo "   Fetching WASM dependencies (freetype, libpng, brotli)..."
+    if [ ! -d "third_party/externals/freetype" ] || [ ! -d "third_party/externals/libpng" ] || [ ! -d "third_party/externals/brotli" ] || \
+       [ ! -d "third_party/externals/libjpeg-turbo" ] || [ ! -d "third_party/externals/libwebp" ]; then
+        echo "   Fetching WASM dependencies (freetype, libpng, brotli, libjpeg-turbo, libwebp)..."
         
         mkdir -p third_party/externals
         cd third_party/externals
@@ -347,6 +348,18 @@ if [[ "$TARGET" == "wasm" ]]; then
             echo "   ✅ brotli cloned"
         fi
         
+        if [ ! -d "libjpeg-turbo" ]; then
+            echo "   Cloning libjpeg-turbo..."
+            git clone --depth 1 https://chromium.googlesource.com/chromium/deps/libjpeg_turbo.git libjpeg-turbo
+            echo "   ✅ libjpeg-turbo cloned"
+        fi
+        
+        if [ ! -d "libwebp" ]; then
+            echo "   Cloning libwebp..."
+            git clone --depth 1 https://chromium.googlesource.com/webm/libwebp.git libwebp
+            echo "   ✅ libwebp cloned"
+        fi
+        
         cd "$SKIA_ROOT"
         echo "   ✅ WASM dependencies fetched"
     fi
@@ -462,10 +475,12 @@ if [[ "$TARGET" == "wasm" ]]; then
         skia_use_freetype=true \
         skia_use_libpng_encode=true \
         skia_use_libpng_decode=true \
-        skia_use_libjpeg_turbo_decode=false \
+        skia_use_libjpeg_turbo_decode=true \
         skia_use_libjpeg_turbo_encode=false \
-        skia_use_libwebp_decode=false \
+        skia_use_libwebp_decode=true \
         skia_use_libwebp_encode=false \
+        skia_use_system_libjpeg_turbo=false \
+        skia_use_system_libwebp=false \
         skia_use_wuffs=false \
         skia_enable_pdf=false \
         skia_use_fontconfig=false \
@@ -513,9 +528,9 @@ else
             skia_use_freetype=true \
             skia_use_libpng_encode=true \
             skia_use_libpng_decode=true \
-            skia_use_libjpeg_turbo_decode=false \
+            skia_use_libjpeg_turbo_decode=true \
             skia_use_libjpeg_turbo_encode=false \
-            skia_use_libwebp_decode=false \
+            skia_use_libwebp_decode=true \
             skia_use_libwebp_encode=false \
             skia_use_wuffs=false \
             skia_use_expat=false \
@@ -540,9 +555,9 @@ else
             skia_use_freetype=true \
             skia_use_libpng_encode=true \
             skia_use_libpng_decode=true \
-            skia_use_libjpeg_turbo_decode=false \
+            skia_use_libjpeg_turbo_decode=true \
             skia_use_libjpeg_turbo_encode=false \
-            skia_use_libwebp_decode=false \
+            skia_use_libwebp_decode=true \
             skia_use_libwebp_encode=false \
             skia_use_wuffs=false \
             skia_use_expat=false \
@@ -20,7 +20,7 @@ set -e
 #
 # SYSTEM LIBRARIES (used but not bundled):
 # ========================================
-# - freetype, harfbuzz, libpng, icu: Use system/Homebrew versions
+# - freetype, harfbuzz, libpng, libjpeg-turbo, libwebp, icu: Use system/Homebrew versions
 # - zlib: System library (used by PNG encoding, available on all platforms)
 # - expat: Linked because fontconfig requires it (system on macOS, system on Linux)
 #
@@ -34,7 +34,7 @@ set -e
 # PLATFORM-SPECIFIC NOTES:
 # ========================
 # macOS:
-#   - Uses Homebrew packages (fontconfig, freetype, harfbuzz, libpng, icu4c - any version)
+#   - Uses Homebrew packages (fontconfig, freetype, harfbuzz, libpng, jpeg-turbo, webp, icu4c - any version)
 #   - Fontconfig links to system expat (/usr/lib/libexpat.1.dylib)
 #   - ICU from Homebrew (any version 44-100, auto-detected) - Skia supports multiple ICU versions
 #   - zlib: System library (/usr/lib/libz.1.dylib)
@@ -42,7 +42,7 @@ set -e
 #
 # Linux (Ubuntu/Debian):
 #   - Uses system packages via apt (libfontconfig1-dev, libexpat1-dev, etc.)
-#   - All libraries (freetype, harfbuzz, libpng, icu, zlib) are system packages
+#   - All libraries (freetype, harfbuzz, libpng, libjpeg-turbo, libwebp, icu, zlib) are system packages
 #   - Libraries in /usr/lib or /usr/lib/x86_64-linux-gnu (or arm64 equivalent)
 #   - ICU version may vary (system package, not necessarily 77)
 #
@@ -243,6 +243,8 @@ echo ""
 # Set up library paths
 if [[ "$OSTYPE" == "darwin"* ]]; then
     PNG_PREFIX=$(brew --prefix libpng 2>/dev/null || echo "$HOMEBREW_PREFIX")
+    JPEG_PREFIX=$(brew --prefix jpeg-turbo 2>/dev/null || echo "$HOMEBREW_PREFIX")
+    WEBP_PREFIX=$(brew --prefix webp 2>/dev/null || echo "$HOMEBREW_PREFIX")
     HARFBUZZ_PREFIX=$(brew --prefix harfbuzz 2>/dev/null || echo "$HOMEBREW_PREFIX")
     FREETYPE_PREFIX=$(brew --prefix freetype 2>/dev/null || echo "$HOMEBREW_PREFIX")
     FONTCONFIG_PREFIX=$(brew --prefix fontconfig 2>/dev/null || echo "$HOMEBREW_PREFIX")
@@ -274,9 +276,11 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
 else
     # Linux: Use system packages (installed via apt)
     # Required packages: libfontconfig1-dev, libexpat1-dev, libfreetype6-dev, 
-    #                    libharfbuzz-dev, libpng-dev, libicu-dev
+    #                    libharfbuzz-dev, libpng-dev, libjpeg-turbo8-dev, libwebp-dev, libicu-dev
     # Libraries are in standard system paths (/usr/lib, /usr/lib64 for x86_64)
     PNG_PREFIX=""
+    JPEG_PREFIX=""
+    WEBP_PREFIX=""
     HARFBUZZ_PREFIX=""
     FREETYPE_PREFIX=""
     FONTCONFIG_PREFIX=""
@@ -309,17 +313,32 @@ trap cleanup_temp_include EXIT
 LIBRARY_SOURCES=(
     "$SRC_DIR/core/argument_parser.cpp"
     "$SRC_DIR/core/animation_setup.cpp"
+    "$SRC_DIR/core/content_bounds.cpp"
     "$SRC_DIR/core/frame_encoder.cpp"
+    "$SRC_DIR/core/image_assets.cpp"
+    "$SRC_DIR/core/image_cache.cpp"
+    "$SRC_DIR/core/pixel_convert.cpp"
     "$SRC_DIR/core/renderer.cpp"
+    "$SRC_DIR/core/render_cache.cpp"
+    "$SRC_DIR/core/sprite_sheet.cpp"
     "$SRC_DIR/utils/crash_handler.cpp"
+    "$SRC_DIR/utils/disk_cache.cpp"
     "$SRC_DIR/utils/logging.cpp"
+    "$SRC_DIR/utils/profiler.cpp"
+    "$SRC_DIR/utils/sha256.cpp"
     "$SRC_DIR/utils/string_utils.cpp"
     "$SRC_DIR/utils/version.cpp"
     "$SRC_DIR/text/layer_overrides.cpp"
     "$SRC_DIR/text/text_processor.cpp"
+    "$SRC_DIR/text/override_template.cpp"
+    "$SRC_DIR/text/directory_font_mgr.cpp"
+    "$SRC_DIR/text/font_service.cpp"
     "$SRC_DIR/text/font_utils.cpp"
+    "$SRC_DIR/text/glyph_run_cache.cpp"
+    "$SRC_DIR/text/text_fit_cache.cpp"
     "$SRC_DIR/text/text_sizing.cpp"
     "$SRC_DIR/text/json_manipulation.cpp"
+    "$SRC_DIR/text/layer_index.cpp"
 )
 
 # Main entry point (separate from library)
@@ -446,6 +465,8 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
         "$MAIN_OBJECT" "$LIBRARY_TARGET" \
         -L"$SKIA_LIB_DIR" -Wl,-rpath,"$SKIA_LIB_DIR" \
         -L"$PNG_PREFIX/lib" \
+        -L"$JPEG_PREFIX/lib" \
+        -L"$WEBP_PREFIX/lib" \
         -L"$HARFBUZZ_PREFIX/lib" \
         -L"$FREETYPE_PREFIX/lib" \
         -L"$FONTCONFIG_PREFIX/lib" \
@@ -459,7 +480,7 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
         "$SKIA_LIB_DIR/libsksg.a" \
         "$SKIA_LIB_DIR/libjsonreader.a" \
         -Wl,-force_load,"$SKIA_LIB_DIR/libskia.a" \
-        -lfreetype -lpng -lharfbuzz \
+        -lfreetype -lpng -ljpeg -lwebpdemux -lwebp -lharfbuzz \
         -L"$ICU_LIB" -licuuc -licui18n -licudata \
         -lz -lfontconfig -lexpat -lm -lpthread \
         -framework CoreFoundation -framework CoreGraphics -framework CoreText \
@@ -481,7 +502,7 @@ else
         "$SKIA_LIB_DIR/libsksg.a" \
         "$SKIA_LIB_DIR/libjsonreader.a" \
         "$SKIA_LIB_DIR/libskia.a" \
-        -lfreetype -lpng -lharfbuzz -licuuc -licui18n -licudata \
+        -lfreetype -lpng -ljpeg -lwebpdemux -lwebp -lharfbuzz -licuuc -licui18n -licudata \
         -lz -lfontconfig -lexpat -lm -lpthread \
         -lX11 -lGL -lGLU \
         -o "$TARGET"
@@ -12,8 +12,9 @@ set -e
 # - freetype (with freetype-no-type1 config for WASM)
 # - libpng
 # - brotli
+# - libjpeg-turbo, libwebp (image asset decoding)
 #
-# All other dependencies are disabled (JPEG, Wuffs, ICU, HarfBuzz, etc.)
+# All other dependencies are disabled (Wuffs, ICU, HarfBuzz, etc.)
 ################################################################################
 
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
@@ -133,8 +134,9 @@ trap cleanup_temp_include EXIT
 REQUIRED_LIBS="skottie skia sksg skshaper skresources jsonreader"
 # Optional libraries (may not exist if features are disabled)
 OPTIONAL_LIBS="skparagraph skunicode"
-# Dependency libraries (brotli is needed by skottie for WOFF2 font support)
-DEPENDENCY_LIBS="brotli"
+# Dependency libraries (brotli is needed by skottie for WOFF2 font support;
+# jpeg and webp are Skia's vendored decoders for JPEG/WebP image assets)
+DEPENDENCY_LIBS="brotli jpeg webp"
 
 SKIA_LIBS=""
 MISSING_REQUIRED=""
@@ -178,11 +180,15 @@ fi
 SOURCES=(
     "$SRC_DIR/wasm/lotio_wasm.cpp"
     "$SRC_DIR/core/frame_encoder.cpp"
+    "$SRC_DIR/core/pixel_convert.cpp"
     "$SRC_DIR/utils/logging.cpp"
     "$SRC_DIR/utils/string_utils.cpp"
     "$SRC_DIR/text/layer_overrides.cpp"
     "$SRC_DIR/text/json_manipulation.cpp"
+    "$SRC_DIR/text/layer_index.cpp"
+    "$SRC_DIR/text/font_service.cpp"
     "$SRC_DIR/text/font_utils.cpp"
+    "$SRC_DIR/text/glyph_run_cache.cpp"
     "$SRC_DIR/text/text_sizing.cpp"
 )
 
@@ -50,14 +50,19 @@ while [[ $# -gt 0 ]]; do
             echo "Additional options:"
             echo "  --output, -o FILE              Output video file (default: output.mov)"
             echo "  --text-padding, -p VALUE       Text padding factor (0.0-1.0, default: 0.97)"
-            echo "  --text-measurement-mode, -m MODE  Text measurement mode: fast|accurate|pixel-perfect (default: accurate)"
+            echo "  --text-measurement-mode, -m MODE  Text measurement mode: fast|accurate|pixel-perfect|hybrid (default: accurate)"
             echo ""
             echo "All lotio options are supported and passed through, including:"
             echo "  --debug                        Enable debug output (shows detailed image loading/rendering logs)"
             echo "  --layer-overrides FILE         Path to layer overrides JSON"
+            echo "  --cache-dir DIR                Reuse rendered frames of identical jobs"
+            echo "  --background COLOR             Flatten onto an opaque color (#RRGGBB) - smaller frames when alpha is not needed"
+            echo "  --image-cache-mb N             Keep at most N MB of decoded images in memory (long slideshow templates)"
+            echo "  --profile-startup              Print startup phase timings (wall time, RSS) to stderr"
+            echo "  --font-dir DIR                 Load fonts from DIR instead of fontconfig (faster cold start)"
             echo ""
             echo "lotio usage:"
-            lotio --help 2>&1 || echo "  lotio [--stream] [--debug] [--layer-overrides <config.json>] [--text-padding <0.0-1.0>] [--text-measurement-mode <fast|accurate|pixel-perfect>] <input.json> <output_dir> [fps]"
+            lotio --help 2>&1 || echo "  lotio [--stream] [--debug] [--layer-overrides <config.json>] [--text-padding <0.0-1.0>] [--text-measurement-mode <fast|accurate|pixel-perfect|hybrid>] <input.json> <output_dir> [fps]"
             echo ""
             echo "Note: --stream is automatically added if not present (required for video encoding)"
             echo ""
@@ -89,6 +94,14 @@ for i in "${!LOTIO_ARGS[@]}"; do
             # If previous arg is a flag that takes a value, this isn't fps
             if [[ "$prev_arg" == "--layer-overrides" ]] || \
                [[ "$prev_arg" == "--text-padding" ]] || \
+               [[ "$prev_arg" == "--at" ]] || \
+               [[ "$prev_arg" == "--sprite-sheet" ]] || \
+               [[ "$prev_arg" == "--sprite-scale" ]] || \
+               [[ "$prev_arg" == "--background" ]] || \
+               [[ "$prev_arg" == "--cache-dir" ]] || \
+               [[ "$prev_arg" == "--cache-max-mb" ]] || \
+               [[ "$prev_arg" == "--image-cache-mb" ]] || \
+               [[ "$prev_arg" == "--font-dir" ]] || \
                [[ "$prev_arg" == "-p" ]] || \
                [[ "$prev_arg" == "--text-measurement-mode" ]] || \
                [[ "$prev_arg" == "-m" ]]; then
@@ -1,15 +1,24 @@
 #include "animation_setup.h"
+#include "image_assets.h"
+#include "image_cache.h"
 #include "../utils/logging.h"
+#include "../utils/profiler.h"
 #include "../text/json_manipulation.h"
+#include "../text/font_service.h"
 #include "../text/text_processor.h"
 #include "modules/skresources/include/SkResources.h"
 #include "include/codec/SkCodec.h"
+#include "include/codec/SkJpegDecoder.h"
 #include "include/codec/SkPngDecoder.h"
-#include "include/ports/SkFontScanner_FreeType.h"
-#include "include/ports/SkFontMgr_fontconfig.h"
-#include <fontconfig/fontconfig.h>
+#include "include/codec/SkWebpDecoder.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
 
 // Logging wrapper for ResourceProvider to debug image loading
 class LoggingResourceProvider : public skresources::ResourceProvider {
@@ -102,57 +111,264 @@ public:
         return result;
     }
 
+    sk_sp<SkData> load(const char path[], const char name[]) const override {
+        return fWrapped->load(path, name);
+    }
+
 private:
     sk_sp<skresources::ResourceProvider> fWrapped;
     std::string fBaseDir;
 };
 
-// Read JSON file and apply layer overrides
-static std::string readAndProcessJson(
-    const std::string& input_file,
-    const std::string& layer_overrides_file,
-    float textPadding,
-    TextMeasurementMode textMeasurementMode
-) {
-    // Read Lottie JSON file
-    std::ifstream file(input_file);
+// Shares decoded image assets of the base template across variants
+// Only assets referenced by the base JSON are kept; assets introduced by image overrides
+// are passed through so the per-variant CachingResourceProvider releases them with the variant
+class TemplateAssetResourceProvider : public skresources::ResourceProvider {
+public:
+    TemplateAssetResourceProvider(sk_sp<skresources::ResourceProvider> wrapped, std::set<std::string> baseAssets)
+        : fWrapped(std::move(wrapped)), fBaseAssets(std::move(baseAssets)) {}
+
+    sk_sp<skresources::ImageAsset> loadImageAsset(const char path[],
+                                                   const char name[],
+                                                   const char id[]) const override {
+        std::string key = imageAssetKey(path, name);
+        if (fBaseAssets.find(key) == fBaseAssets.end()) {
+            return fWrapped->loadImageAsset(path, name, id);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            auto it = fAssets.find(key);
+            if (it != fAssets.end()) {
+                LOG_DEBUG("[TEMPLATE] Reusing decoded base asset: " << key);
+                return it->second;
+            }
+        }
+        // Load without holding the lock so different assets decode in parallel
+        auto asset = fWrapped->loadImageAsset(path, name, id);
+        if (asset) {
+            std::lock_guard<std::mutex> lock(fMutex);
+            // Another thread may have loaded the same asset meanwhile; keep the first one
+            asset = fAssets.emplace(key, asset).first->second;
+        }
+        return asset;
+    }
+
+    sk_sp<SkTypeface> loadTypeface(const char name[],
+                                   const char url[]) const override {
+        return fWrapped->loadTypeface(name, url);
+    }
+
+    sk_sp<SkData> load(const char path[], const char name[]) const override {
+        return fWrapped->load(path, name);
+    }
+
+private:
+    sk_sp<skresources::ResourceProvider> fWrapped;
+    std::set<std::string> fBaseAssets;  // "u" + "p" of every image asset in the base JSON
+    mutable std::mutex fMutex;
+    mutable std::map<std::string, sk_sp<skresources::ImageAsset>> fAssets;
+};
+
+// Collect "u" + "p" keys of the image assets referenced by the base JSON
+static std::set<std::string> collectBaseImageAssets(const SkData& json_data) {
+    std::set<std::string> keys;
+    for (const auto& asset : collectImageAssets(json_data)) {
+        keys.insert(imageAssetKey(asset.path.c_str(), asset.name.c_str()));
+    }
+    return keys;
+}
+
+// Wrap a string in SkData without copying; the data owns the string from here on
+static sk_sp<SkData> adoptStringAsData(std::string&& str) {
+    auto* owned = new std::string(std::move(str));
+    return SkData::MakeWithProc(owned->data(), owned->size(),
+                                [](const void*, void* context) { delete static_cast<std::string*>(context); },
+                                owned);
+}
+
+// Read the whole file with buffered reads, for inputs that cannot be mapped (pipes, special files)
+static sk_sp<SkData> readFileStreaming(const std::string& input_file) {
+    std::ifstream file(input_file, std::ios::binary);
     if (!file.is_open()) {
-        LOG_CERR("Error: Could not open input file: " << input_file) << std::endl;
-        return "";
+        return nullptr;
+    }
+    std::string contents;
+    std::vector<char> buffer(1024 * 1024);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        contents.append(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return adoptStringAsData(std::move(contents));
+}
+
+// True if the JSON contains a U+0003 soft line break that normalizeLottieTextNewlines() rewrites
+static bool containsTextBreakMarker(const SkData& json_data) {
+    const char* begin = static_cast<const char*>(json_data.data());
+    const char* end = begin + json_data.size();
+    static const char kEscaped[] = "\\u0003";
+    if (std::memchr(begin, '\x03', json_data.size()) != nullptr) {
+        return true;
     }
+    return std::search(begin, end, kEscaped, kEscaped + sizeof(kEscaped) - 1) != end;
+}
 
-    std::string json_data((std::istreambuf_iterator<char>(file)),
-                          std::istreambuf_iterator<char>());
-    file.close();
+// Load the JSON file and normalize text newlines
+// The file is memory-mapped and returned as-is unless normalization has to rewrite it, so large
+// files with embedded images are neither copied nor parsed here
+static sk_sp<SkData> loadInputJson(const std::string& input_file) {
+    ScopedPhase read_phase("read input JSON");
+    sk_sp<SkData> json_data = SkData::MakeFromFileName(input_file.c_str());
+    if (json_data) {
+        LOG_DEBUG("Memory-mapped input JSON: " << input_file << " (" << json_data->size() << " bytes)");
+    } else {
+        json_data = readFileStreaming(input_file);
+        if (!json_data) {
+            LOG_CERR("Error: Could not open input file: " << input_file) << std::endl;
+            return nullptr;
+        }
+        LOG_DEBUG("Read input JSON: " << input_file << " (" << json_data->size() << " bytes)");
+    }
+    if (json_data->size() == 0) {
+        LOG_CERR("Error: Input file is empty: " << input_file) << std::endl;
+        return nullptr;
+    }
+    read_phase.end();
 
     // Register codecs needed by SkResources FileResourceProvider for image decoding.
     // (SkResources docs: clients must call SkCodec::Register() before using FileResourceProvider.)
+    ScopedPhase codec_phase("register image codecs");
     SkCodecs::Register(SkPngDecoder::Decoder());
-    LOG_DEBUG("Registered image codecs via SkCodecs::Register: png");
-    LOG_DEBUG("Image decoder ready - PNG format supported");
+    SkCodecs::Register(SkJpegDecoder::Decoder());
+    SkCodecs::Register(SkWebpDecoder::Decoder());
+    LOG_DEBUG("Registered image codecs via SkCodecs::Register: png, jpeg, webp");
+    LOG_DEBUG("Image decoder ready - PNG, JPEG and WebP formats supported");
+    codec_phase.end();
+
+    ScopedPhase normalize_phase("normalize text newlines");
+    if (containsTextBreakMarker(*json_data)) {
+        LOG_DEBUG("Input JSON contains U+0003 text breaks - normalizing a private copy");
+        std::string normalized(static_cast<const char*>(json_data->data()), json_data->size());
+        json_data.reset();  // Release the mapping; only the normalized copy is kept
+        normalizeLottieTextNewlines(normalized);
+        json_data = adoptStringAsData(std::move(normalized));
+    }
 
-    normalizeLottieTextNewlines(json_data);
-    
-    // Apply layer overrides if config file is provided
-    processLayerOverrides(json_data, layer_overrides_file, textPadding, textMeasurementMode);
-    
     return json_data;
 }
 
-AnimationSetupResult setupAndCreateAnimation(
+bool loadAnimationTemplate(
     const std::string& input_file,
+    AnimationTemplate& tmpl,
+    bool shareBaseAssets
+) {
+    tmpl.input_file = input_file;
+
+    // Load and normalize JSON once for all variants
+    tmpl.json_data = loadInputJson(input_file);
+    if (!tmpl.json_data) {
+        return false;
+    }
+
+    // Resource provider (images, etc.)
+    ScopedPhase provider_phase("resource provider setup");
+    std::filesystem::path jsonPath(input_file);
+    std::filesystem::path baseDir = jsonPath.has_parent_path() ? jsonPath.parent_path()
+                                                               : std::filesystem::path(".");
+    std::error_code ec;
+    std::filesystem::path absBaseDir = std::filesystem::absolute(baseDir, ec);
+    tmpl.base_dir = (ec ? baseDir.string() : absBaseDir.string());
+    const auto& baseDirStr = tmpl.base_dir;
+
+    LOG_DEBUG("ResourceProvider base_dir: " << baseDirStr);
+
+    // Check if base directory exists
+    if (!std::filesystem::exists(baseDirStr)) {
+        LOG_CERR("[WARNING] ResourceProvider base directory does not exist: " << baseDirStr) << std::endl;
+    } else if (!std::filesystem::is_directory(baseDirStr)) {
+        LOG_CERR("[WARNING] ResourceProvider base path is not a directory: " << baseDirStr) << std::endl;
+    } else {
+        LOG_DEBUG("ResourceProvider base directory verified: " << baseDirStr);
+    }
+
+    auto fileRP = skresources::FileResourceProvider::Make(SkString(baseDirStr.c_str()),
+                                                          skresources::ImageDecodeStrategy::kPreDecode);
+    if (!fileRP) {
+        LOG_CERR("[ERROR] Failed to create skresources::FileResourceProvider for base_dir=" << baseDirStr) << std::endl;
+        LOG_CERR("[ERROR] Images may fail to load - check base directory path and permissions") << std::endl;
+    } else {
+        LOG_DEBUG("FileResourceProvider created successfully with kPreDecode strategy");
+        LOG_DEBUG("Images will be pre-decoded when loaded from: " << baseDirStr);
+
+        // Wrap FileResourceProvider with logging wrapper for debugging
+        auto loggingRP = sk_make_sp<LoggingResourceProvider>(std::move(fileRP), baseDirStr);
+        LOG_DEBUG("LoggingResourceProvider wrapper created - will log all image loading attempts");
+
+        std::set<std::string> baseAssets;
+        if (shareBaseAssets) {
+            baseAssets = collectBaseImageAssets(*tmpl.json_data);
+            LOG_DEBUG("Template shares " << baseAssets.size() << " base image assets across variants");
+            tmpl.scaled_images = sk_make_sp<ScaledImageCache>(baseAssets);
+        }
+        tmpl.resource_provider = sk_make_sp<TemplateAssetResourceProvider>(std::move(loggingRP), std::move(baseAssets));
+    }
+
+    provider_phase.end();
+
+    // Templates shared by many variants compile the override offsets once up front
+    if (shareBaseAssets) {
+        ScopedPhase compile_phase("compile override template");
+        auto compiled = std::make_shared<OverrideTemplate>();
+        if (compileOverrideTemplate(static_cast<const char*>(tmpl.json_data->data()), tmpl.json_data->size(), *compiled)) {
+            tmpl.override_template = std::move(compiled);
+        }
+    }
+
+    ScopedPhase font_phase("font manager");
+    tmpl.font_manager = sharedFontManager();
+    return true;
+}
+
+AnimationSetupResult instantiateAnimationTemplate(
+    const AnimationTemplate& tmpl,
     const std::string& layer_overrides_file,
     float textPadding,
-    TextMeasurementMode textMeasurementMode
+    TextMeasurementMode textMeasurementMode,
+    size_t imageCacheBytes
 ) {
     AnimationSetupResult result;
-    
-    // Read and process JSON (apply layer overrides if needed)
-    result.processed_json = readAndProcessJson(input_file, layer_overrides_file, textPadding, textMeasurementMode);
-    if (result.processed_json.empty()) {
+    if (!tmpl.loaded()) {
         return result;  // animation will be nullptr
     }
-    
+
+    result.base_dir = tmpl.base_dir;
+    if (layer_overrides_file.empty()) {
+        // Nothing to apply: Skottie parses the template bytes directly (no copy)
+        result.json_data = tmpl.json_data;
+    } else {
+        // Apply layer overrides by splicing the new values into the template bytes; fall back to
+        // editing the parsed document when the template has no offsets for an edit
+        ScopedPhase overrides_phase("layer overrides");
+        const char* templateJson = static_cast<const char*>(tmpl.json_data->data());
+        const size_t templateSize = tmpl.json_data->size();
+        std::shared_ptr<const OverrideTemplate> compiled = tmpl.override_template;
+        if (!compiled) {
+            auto local = std::make_shared<OverrideTemplate>();
+            if (compileOverrideTemplate(templateJson, templateSize, *local)) {
+                compiled = std::move(local);
+            }
+        }
+        std::string processed_json;
+        if (!compiled || !spliceLayerOverrides(*compiled, templateJson, templateSize, layer_overrides_file,
+                                               processed_json, textPadding, textMeasurementMode,
+                                               tmpl.font_manager.get())) {
+            LOG_DEBUG("Applying layer overrides to the parsed JSON document");
+            processed_json.assign(templateJson, templateSize);
+            processLayerOverrides(processed_json, layer_overrides_file, textPadding, textMeasurementMode,
+                                  tmpl.font_manager.get());
+        }
+        result.json_data = adoptStringAsData(std::move(processed_json));
+    }
+
     // Debug: save modified JSON to file for inspection
     if (g_debug_mode && !layer_overrides_file.empty()) {
         // Try multiple paths: workspace (Docker), current dir, temp dir
@@ -166,7 +382,7 @@ AnimationSetupResult setupAndCreateAnimation(
         for (const auto& path : debugPaths) {
             std::ofstream debugFile(path);
             if (debugFile.is_open()) {
-                debugFile << result.processed_json;
+                debugFile.write(static_cast<const char*>(result.json_data->data()), result.json_data->size());
                 debugFile.close();
                 LOG_DEBUG("Saved modified JSON to " << path << " for inspection");
                 saved = true;
@@ -181,83 +397,42 @@ AnimationSetupResult setupAndCreateAnimation(
     // Builder is already default-constructed in struct
     
     LOG_DEBUG("Creating Skottie animation...");
-    LOG_DEBUG("JSON size: " << result.processed_json.length() << " bytes");
-    
-    // Resource provider (images, etc.)
-    {
-        std::filesystem::path jsonPath(input_file);
-        std::filesystem::path baseDir = jsonPath.has_parent_path() ? jsonPath.parent_path()
-                                                                   : std::filesystem::path(".");
-        std::error_code ec;
-        std::filesystem::path absBaseDir = std::filesystem::absolute(baseDir, ec);
-        const auto baseDirStr = (ec ? baseDir.string() : absBaseDir.string());
-
-        LOG_DEBUG("ResourceProvider base_dir: " << baseDirStr);
-        
-        // Check if base directory exists
-        if (!std::filesystem::exists(baseDirStr)) {
-            LOG_CERR("[WARNING] ResourceProvider base directory does not exist: " << baseDirStr) << std::endl;
-        } else if (!std::filesystem::is_directory(baseDirStr)) {
-            LOG_CERR("[WARNING] ResourceProvider base path is not a directory: " << baseDirStr) << std::endl;
-        } else {
-            LOG_DEBUG("ResourceProvider base directory verified: " << baseDirStr);
-        }
-        
-        auto fileRP = skresources::FileResourceProvider::Make(SkString(baseDirStr.c_str()),
-                                                              skresources::ImageDecodeStrategy::kPreDecode);
-        if (!fileRP) {
-            LOG_CERR("[ERROR] Failed to create skresources::FileResourceProvider for base_dir=" << baseDirStr) << std::endl;
-            LOG_CERR("[ERROR] Images may fail to load - check base directory path and permissions") << std::endl;
-        } else {
-            LOG_DEBUG("FileResourceProvider created successfully with kPreDecode strategy");
-            LOG_DEBUG("Images will be pre-decoded when loaded from: " << baseDirStr);
-            
-            // Wrap FileResourceProvider with logging wrapper for debugging
-            auto loggingRP = sk_make_sp<LoggingResourceProvider>(std::move(fileRP), baseDirStr);
-            LOG_DEBUG("LoggingResourceProvider wrapper created - will log all image loading attempts");
-            
-            // Wrap logging provider with caching
-            auto cachingRP = skresources::CachingResourceProvider::Make(std::move(loggingRP));
-            result.builder.setResourceProvider(std::move(cachingRP));
-            LOG_DEBUG("ResourceProvider set (FileResourceProvider + LoggingResourceProvider + CachingResourceProvider)");
-            LOG_DEBUG("Image loading ready - resources will be cached for performance");
-        }
-    }
+    LOG_DEBUG("JSON size: " << result.json_data->size() << " bytes");
 
-    // Font manager: Use fontconfig (handles both system fonts and custom fonts via fontconfig)
-    // Custom fonts in /usr/local/share/fonts should be registered via fc-cache
-    LOG_DEBUG("Setting up font manager...");
-    sk_sp<SkFontMgr> fontMgr;
-    
-    try {
-        const auto fcInitOk = FcInit();
-        LOG_DEBUG("FcInit() returned " << (fcInitOk ? "true" : "false"));
-
-        auto scanner = SkFontScanner_Make_FreeType();
-        if (!scanner) {
-            LOG_CERR("[ERROR] SkFontScanner_Make_FreeType() returned nullptr; cannot use fontconfig") << std::endl;
-            fontMgr = SkFontMgr::RefEmpty();
+    if (tmpl.resource_provider) {
+        ScopedPhase images_phase("image assets");
+        // Collected once: the image providers and the render cache key use the same list
+        result.image_assets = collectImageAssets(*result.json_data);
+        sk_sp<skresources::ResourceProvider> imageRP;
+        if (imageCacheBytes > 0) {
+            // Decode images on first use and keep at most imageCacheBytes of pixels resident
+            auto lazyRP = LazyImageResourceProvider::Make(tmpl.resource_provider, *result.json_data,
+                                                          result.image_assets, imageCacheBytes);
+            result.image_cache = lazyRP->cache();
+            imageRP = std::move(lazyRP);
         } else {
-            fontMgr = SkFontMgr_New_FontConfig(nullptr, std::move(scanner));
-            if (fontMgr) {
-                LOG_DEBUG("Fontconfig font manager created successfully");
-                LOG_DEBUG("Fontconfig will find system fonts and custom fonts (if registered via fc-cache)");
-            } else {
-                LOG_CERR("[ERROR] Failed to create fontconfig font manager") << std::endl;
-                fontMgr = SkFontMgr::RefEmpty();
-            }
+            // Decode every image this variant references in parallel before Skottie asks for them one at a time
+            imageRP = PreDecodedResourceProvider::Make(tmpl.resource_provider, result.image_assets,
+                                                       tmpl.scaled_images.get());
         }
-    } catch (...) {
-        LOG_CERR("[ERROR] Exception creating fontconfig font manager") << std::endl;
-        fontMgr = SkFontMgr::RefEmpty();
+        // Per-variant cache so per-thread animations of this variant reuse the loaded assets
+        auto cachingRP = skresources::CachingResourceProvider::Make(std::move(imageRP));
+        result.builder.setResourceProvider(std::move(cachingRP));
+        LOG_DEBUG("ResourceProvider set (FileResourceProvider + LoggingResourceProvider + TemplateAssetResourceProvider + "
+                  << (imageCacheBytes > 0 ? "LazyImageResourceProvider" : "PreDecodedResourceProvider")
+                  << " + CachingResourceProvider)");
+        LOG_DEBUG("Image loading ready - resources will be cached for performance");
     }
-    
-    result.builder.setFontManager(fontMgr);
+
+    result.builder.setFontManager(tmpl.font_manager);
     LOG_DEBUG("Font manager set on builder");
 
     LOG_DEBUG("Calling builder.make() to parse JSON...");
     LOG_DEBUG("Parsing animation JSON (this will load and decode images if present)...");
-    result.animation = result.builder.make(result.processed_json.c_str(), result.processed_json.length());
+    ScopedPhase make_phase("builder.make (main animation)");
+    result.animation = result.builder.make(static_cast<const char*>(result.json_data->data()),
+                                           result.json_data->size());
+    make_phase.end();
     
     if (!result.animation) {
         LOG_CERR("[ERROR] Failed to parse Lottie animation from JSON") << std::endl;
@@ -279,3 +454,18 @@ AnimationSetupResult setupAndCreateAnimation(
     return result;
 }
 
+AnimationSetupResult setupAndCreateAnimation(
+    const std::string& input_file,
+    const std::string& layer_overrides_file,
+    float textPadding,
+    TextMeasurementMode textMeasurementMode,
+    size_t imageCacheBytes
+) {
+    // Single-use template: nothing to share across variants, so skip the asset scan
+    AnimationTemplate tmpl;
+    if (!loadAnimationTemplate(input_file, tmpl, false)) {
+        return AnimationSetupResult();  // animation will be nullptr
+    }
+    return instantiateAnimationTemplate(tmpl, layer_overrides_file, textPadding, textMeasurementMode, imageCacheBytes);
+}
+
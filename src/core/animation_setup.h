@@ -2,30 +2,81 @@
 #define ANIMATION_SETUP_H
 
 #include <skia/modules/skottie/include/Skottie.h>
+#include <skia/modules/skresources/include/SkResources.h>
 #include <skia/core/SkFontMgr.h>
+#include <skia/core/SkData.h>
 #include <string>
 #include <memory>
+#include <vector>
 #include "../text/font_utils.h"
+#include "../text/override_template.h"
+#include "image_assets.h"
+#include "image_cache.h"
 
 // Animation setup result
 struct AnimationSetupResult {
     sk_sp<skottie::Animation> animation;
     skottie::Animation::Builder builder{};  // Default construct in place
-    std::string processed_json;
-    
+    sk_sp<SkData> json_data;  // JSON given to Skottie: the mapped input file when no overrides apply
+    std::string base_dir;  // Base directory used to resolve image assets
+    sk_sp<ImageAssetCache> image_cache;  // Lazy image cache (null when images are pre-decoded)
+    std::vector<ImageAssetRef> image_assets;  // External images referenced by json_data
+
     bool success() const { return animation != nullptr; }
 };
 
+// Animation template: a base animation loaded once and instantiated with many layer-override sets
+// Holds the normalized JSON (a read-only mapping of the input file unless normalization had to
+// rewrite it), a resource provider and a scaled-decode cache that keep decoded base image assets
+// alive across variants, the font manager used for both text measurement and Skottie, and the
+// compiled override offsets that let each variant splice its values into the template bytes
+struct AnimationTemplate {
+    std::string input_file;
+    std::string base_dir;                                     // Base directory for resolving image assets
+    sk_sp<SkData> json_data;                                  // Input JSON after newline normalization
+    sk_sp<skresources::ResourceProvider> resource_provider;   // Shared by all variants
+    sk_sp<ScaledImageCache> scaled_images;                    // Downscaled base assets (null: not shared)
+    sk_sp<SkFontMgr> font_manager;                            // Shared by all variants
+    std::shared_ptr<const OverrideTemplate> override_template; // Null: compiled per instantiation
+
+    bool loaded() const { return json_data != nullptr; }
+};
+
+// Load a template: map and normalize the JSON, create the resource provider and font manager
+// shareBaseAssets: keep decoded image assets referenced by the base JSON alive across variants
+//                  (images replaced by overrides are decoded per variant and released with it)
+//                  and compile the override offsets once for all variants
+// Returns true on success
+bool loadAnimationTemplate(
+    const std::string& input_file,
+    AnimationTemplate& tmpl,
+    bool shareBaseAssets = true
+);
+
+// Create an animation from a loaded template by applying one layer-overrides file
+// Only the overridden text layers and image assets are recomputed
+// imageCacheBytes: 0 decodes all images up front; otherwise images are decoded on first use and
+//                  evicted to keep decoded pixels within this budget (see result.image_cache)
+AnimationSetupResult instantiateAnimationTemplate(
+    const AnimationTemplate& tmpl,
+    const std::string& layer_overrides_file,
+    float textPadding = 0.97f,
+    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE,
+    size_t imageCacheBytes = 0
+);
+
 // Setup Skottie animation builder and create animation
 // Reads JSON file, applies layer overrides (text and image), and creates animation
-// Returns result with animation, builder, and processed JSON on success
+// Returns result with animation, builder, and the JSON Skottie parsed on success
 // textPadding: padding factor (0.0-1.0), default 0.97 means 97% of target width (3% padding)
 // textMeasurementMode: measurement accuracy mode (default: ACCURATE for good balance)
+// imageCacheBytes: decoded image budget (0 = decode all images up front)
 AnimationSetupResult setupAndCreateAnimation(
     const std::string& input_file,
     const std::string& layer_overrides_file,
     float textPadding = 0.97f,
-    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE
+    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE,
+    size_t imageCacheBytes = 0
 );
 
 #endif // ANIMATION_SETUP_H
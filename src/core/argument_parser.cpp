@@ -8,16 +8,86 @@
 #include <filesystem>
 #include <fstream>
 
+// Parse --at value: comma-separated frame indices ("12") or times in seconds ("1.5s")
+static bool parseFrameSelections(const std::string& value, std::vector<FrameSelection>& selections) {
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        std::string item = value.substr(start, end - start);
+        if (item.empty()) {
+            return false;
+        }
+
+        FrameSelection selection;
+        size_t parsed = 0;
+        try {
+            if (item.back() == 's') {
+                selection.is_seconds = true;
+                item.pop_back();
+                selection.value = std::stod(item, &parsed);
+            } else {
+                selection.value = static_cast<double>(std::stoll(item, &parsed));
+            }
+        } catch (...) {
+            return false;
+        }
+        if (parsed != item.size() || selection.value < 0.0) {
+            return false;
+        }
+        selections.push_back(selection);
+        start = end + 1;
+    }
+    return !selections.empty();
+}
+
+// Parse --background value: #RGB or #RRGGBB (leading '#' optional) into opaque 0xFFRRGGBB
+static bool parseBackgroundColor(std::string value, uint32_t& color) {
+    if (!value.empty() && value[0] == '#') {
+        value.erase(0, 1);
+    }
+    if (value.size() == 3) {
+        // Expand #RGB to #RRGGBB
+        value = std::string{value[0], value[0], value[1], value[1], value[2], value[2]};
+    }
+    auto isHexDigit = [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; };
+    if (value.size() != 6 || !std::all_of(value.begin(), value.end(), isHexDigit)) {
+        return false;
+    }
+    color = 0xFF000000u | static_cast<uint32_t>(std::stoul(value, nullptr, 16));
+    return true;
+}
+
 void printUsage(const char* program_name) {
-    std::cerr << "Usage: " << program_name << " [--stream] [--debug] [--layer-overrides <config.json>] [--text-padding <0.0-1.0>] [--text-measurement-mode <fast|accurate|pixel-perfect>] <input.json> <output_dir> [fps]" << std::endl;
+    std::cerr << "Usage: " << program_name << " [--stream] [--debug] [--profile-startup] [--layer-overrides <config.json>] [--variants <list.txt>] [--at <frame|seconds>s[,...]] [--sprite-sheet <columns>] [--sprite-scale <0.0-1.0>] [--auto-trim] [--background <#RRGGBB>] [--cache-dir <dir>] [--cache-max-mb <n>] [--image-cache-mb <n>] [--font-dir <dir>] [--text-padding <0.0-1.0>] [--text-measurement-mode <fast|accurate|pixel-perfect|hybrid>] <input.json> <output_dir> [fps]" << std::endl;
     std::cerr << "  --stream:               Stream frames to stdout as PNG (for piping to ffmpeg)" << std::endl;
     std::cerr << "  --debug:                Enable debug output" << std::endl;
+    std::cerr << "  --profile-startup:      Print wall time and RSS change of each startup phase to stderr" << std::endl;
     std::cerr << "  --layer-overrides:      Path to layer overrides JSON (for text auto-fit, dynamic text values, and image path overrides)" << std::endl;
+    std::cerr << "  --variants:             Render one animation per layer overrides file listed in <list.txt>" << std::endl;
+    std::cerr << "                          (one path per line, relative to the list file; output goes to <output_dir>/<name>/)" << std::endl;
+    std::cerr << "  --at:                   Render only the listed frames, e.g. 0,48 (frame indices at output fps) or 1.5s (seconds)" << std::endl;
+    std::cerr << "                          Output frames are numbered in the order given" << std::endl;
+    std::cerr << "  --sprite-sheet:         Pack frames into <output_dir>/spritesheet.png with <columns> tiles per row," << std::endl;
+    std::cerr << "                          plus a frame index in <output_dir>/spritesheet.json" << std::endl;
+    std::cerr << "  --sprite-scale:         Sprite sheet tile scale (0.0-1.0, default: 1.0)" << std::endl;
+    std::cerr << "  --auto-trim:            Crop frames to the union of animated content bounds (offset written to <output_dir>/trim.json)" << std::endl;
+    std::cerr << "  --background:           Flatten frames onto an opaque color (#RGB or #RRGGBB) and encode RGB PNGs without alpha" << std::endl;
+    std::cerr << "  --cache-dir:            Reuse rendered frames of identical jobs from this directory (populated on first render)" << std::endl;
+    std::cerr << "  --cache-max-mb:         Render cache size limit in MB; least recently used entries are evicted (default: 1024, 0 = unlimited)" << std::endl;
+    std::cerr << "  --image-cache-mb:       Decode image assets on first use and keep at most <n> MB of decoded pixels," << std::endl;
+    std::cerr << "                          evicting images whose layers are inactive (default: 0 = decode all images up front)" << std::endl;
+    std::cerr << "  --font-dir:             Load fonts from this directory (TTF/OTF) instead of fontconfig; the font list is" << std::endl;
+    std::cerr << "                          indexed once in <dir>/.lotio-font-index (read-only dirs: <cache-dir>/_fontindex" << std::endl;
+    std::cerr << "                          or $TMPDIR/lotio-font-index)" << std::endl;
     std::cerr << "  --text-padding:         Text padding factor (0.0-1.0, default: 0.97 = 3% padding)" << std::endl;
-    std::cerr << "  --text-measurement-mode: Text measurement mode (fast|accurate|pixel-perfect, default: accurate)" << std::endl;
+    std::cerr << "  --text-measurement-mode: Text measurement mode (fast|accurate|pixel-perfect|hybrid, default: accurate)" << std::endl;
     std::cerr << "                          fast: Fastest, basic accuracy" << std::endl;
     std::cerr << "                          accurate: Good balance, accounts for kerning and glyph metrics" << std::endl;
     std::cerr << "                          pixel-perfect: Most accurate, accounts for anti-aliasing" << std::endl;
+    std::cerr << "                          hybrid: Sizes searched as accurate, fit verified pixel-perfect" << std::endl;
     std::cerr << "  --version:              Print version information and exit" << std::endl;
     std::cerr << "  --help, -h:             Show this help message" << std::endl;
     std::cerr << "  fps:                    Frames per second for output (default: animation fps or 30)" << std::endl;
@@ -37,6 +107,10 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
             args.stream_mode = true;
         } else if (arg == "--debug") {
             args.debug_mode = true;
+        } else if (arg == "--profile-startup") {
+            args.profile_startup = true;
+        } else if (arg == "--auto-trim") {
+            args.auto_trim = true;
         } else if (arg == "--layer-overrides") {
             if (i + 1 < argc) {
                 args.layer_overrides_file = argv[++i];
@@ -44,6 +118,115 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
                 std::cerr << "Error: --layer-overrides requires a file path" << std::endl;
                 return 1;
             }
+        } else if (arg == "--variants") {
+            if (i + 1 < argc) {
+                args.variants_file = argv[++i];
+            } else {
+                std::cerr << "Error: --variants requires a file path" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--at") {
+            if (i + 1 < argc) {
+                if (!parseFrameSelections(argv[++i], args.at_frames)) {
+                    std::cerr << "Error: Invalid --at value: " << argv[i] << std::endl;
+                    std::cerr << "  Expected comma-separated frame indices (e.g. 0,48) or seconds (e.g. 1.5s)" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --at requires a value" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sprite-sheet") {
+            if (i + 1 < argc) {
+                try {
+                    args.sprite_columns = std::stoi(argv[++i]);
+                    if (args.sprite_columns < 1) {
+                        std::cerr << "Error: --sprite-sheet columns must be at least 1" << std::endl;
+                        return 1;
+                    }
+                } catch (...) {
+                    std::cerr << "Error: Invalid --sprite-sheet value: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sprite-sheet requires a column count" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sprite-scale") {
+            if (i + 1 < argc) {
+                try {
+                    args.sprite_scale = std::stof(argv[++i]);
+                    if (args.sprite_scale <= 0.0f || args.sprite_scale > 1.0f) {
+                        std::cerr << "Error: --sprite-scale must be greater than 0.0 and at most 1.0" << std::endl;
+                        return 1;
+                    }
+                } catch (...) {
+                    std::cerr << "Error: Invalid --sprite-scale value: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sprite-scale requires a value" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--background") {
+            if (i + 1 < argc) {
+                if (!parseBackgroundColor(argv[++i], args.background_color)) {
+                    std::cerr << "Error: Invalid --background color: " << argv[i] << std::endl;
+                    std::cerr << "  Expected #RGB or #RRGGBB (e.g. #000 or #1a2b3c)" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --background requires a color" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                args.cache_dir = argv[++i];
+            } else {
+                std::cerr << "Error: --cache-dir requires a directory path" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cache-max-mb") {
+            if (i + 1 < argc) {
+                try {
+                    long long value = std::stoll(argv[++i]);
+                    if (value < 0) {
+                        std::cerr << "Error: --cache-max-mb cannot be negative" << std::endl;
+                        return 1;
+                    }
+                    args.cache_max_mb = static_cast<uint64_t>(value);
+                } catch (...) {
+                    std::cerr << "Error: Invalid --cache-max-mb value: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --cache-max-mb requires a value" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--image-cache-mb") {
+            if (i + 1 < argc) {
+                try {
+                    long long value = std::stoll(argv[++i]);
+                    if (value < 0) {
+                        std::cerr << "Error: --image-cache-mb cannot be negative" << std::endl;
+                        return 1;
+                    }
+                    args.image_cache_mb = static_cast<uint64_t>(value);
+                } catch (...) {
+                    std::cerr << "Error: Invalid --image-cache-mb value: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --image-cache-mb requires a value" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--font-dir") {
+            if (i + 1 < argc) {
+                args.font_dir = argv[++i];
+            } else {
+                std::cerr << "Error: --font-dir requires a directory path" << std::endl;
+                return 1;
+            }
         } else if (arg == "--text-padding") {
             if (i + 1 < argc) {
                 try {
@@ -73,9 +256,11 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
                     args.text_measurement_mode = TextMeasurementMode::ACCURATE;
                 } else if (modeStr == "pixel-perfect" || modeStr == "pixelperfect") {
                     args.text_measurement_mode = TextMeasurementMode::PIXEL_PERFECT;
+                } else if (modeStr == "hybrid") {
+                    args.text_measurement_mode = TextMeasurementMode::HYBRID;
                 } else {
                     std::cerr << "Error: Invalid --text-measurement-mode value: " << argv[i] << std::endl;
-                    std::cerr << "  Valid values: fast, accurate, pixel-perfect" << std::endl;
+                    std::cerr << "  Valid values: fast, accurate, pixel-perfect, hybrid" << std::endl;
                     return 1;
                 }
             } else {
@@ -147,6 +332,63 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
     }
     test_file.close();
 
+    if (args.sprite_columns > 0 && args.stream_mode) {
+        std::cerr << "Error: --sprite-sheet cannot be combined with --stream" << std::endl;
+        return 1;
+    }
+    if (args.sprite_columns > 0 && args.background_color != 0) {
+        std::cerr << "Error: --background cannot be combined with --sprite-sheet (sprite sheets keep alpha)" << std::endl;
+        return 1;
+    }
+
+    // Read variants list (one layer-overrides file per line)
+    if (!args.variants_file.empty()) {
+        if (args.stream_mode) {
+            std::cerr << "Error: --variants cannot be combined with --stream" << std::endl;
+            return 1;
+        }
+        if (!args.layer_overrides_file.empty()) {
+            std::cerr << "Error: --variants cannot be combined with --layer-overrides (list the file in the variants list instead)" << std::endl;
+            return 1;
+        }
+
+        std::ifstream variants_stream(args.variants_file);
+        if (!variants_stream.is_open()) {
+            std::cerr << "Error: Cannot open variants list: " << args.variants_file << std::endl;
+            return 1;
+        }
+
+        std::filesystem::path variants_path(args.variants_file);
+        std::filesystem::path variants_base_dir = variants_path.has_parent_path()
+            ? variants_path.parent_path()
+            : std::filesystem::path(".");
+
+        std::string line;
+        while (std::getline(variants_stream, line)) {
+            // Trim whitespace (and '\r' from CRLF files); skip blank lines and '#' comments
+            const auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;
+            }
+            const auto last = line.find_last_not_of(" \t\r");
+            std::filesystem::path overrides_path(line.substr(first, last - first + 1));
+            if (overrides_path.is_relative()) {
+                overrides_path = variants_base_dir / overrides_path;
+            }
+            if (!std::filesystem::is_regular_file(overrides_path)) {
+                std::cerr << "Error: Layer overrides file in variants list does not exist: " << overrides_path.string() << std::endl;
+                return 1;
+            }
+            args.variant_overrides.push_back(overrides_path.string());
+        }
+
+        if (args.variant_overrides.empty()) {
+            std::cerr << "Error: Variants list is empty: " << args.variants_file << std::endl;
+            return 1;
+        }
+        LOG_DEBUG("Loaded " << args.variant_overrides.size() << " variants from " << args.variants_file);
+    }
+
     // Handle output directory (not needed in stream mode)
     if (!args.stream_mode) {
         if (args.output_dir.empty()) {
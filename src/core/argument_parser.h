@@ -2,7 +2,10 @@
 #define ARGUMENT_PARSER_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
 #include "../text/font_utils.h"
+#include "renderer.h"
 
 // Command-line arguments structure
 struct Arguments {
@@ -12,8 +15,20 @@ struct Arguments {
     std::string input_file;
     std::string output_dir;
     std::string layer_overrides_file;
+    std::string variants_file;  // --variants list file (one layer-overrides path per line)
+    std::vector<std::string> variant_overrides;  // Layer-overrides files read from variants_file
     float fps = 30.0f;
     bool fps_explicitly_set = false;  // Track if fps was provided on command line
+    std::vector<FrameSelection> at_frames;  // --at: render only these frames/times (empty = all)
+    int sprite_columns = 0;  // --sprite-sheet: tiles per row (0 = write frame files)
+    float sprite_scale = 1.0f;  // --sprite-scale: tile size relative to the animation size
+    uint32_t background_color = 0;  // --background as 0xAARRGGBB (0 = transparent output)
+    bool auto_trim = false;  // --auto-trim: crop frames to the animated content bounds
+    std::string cache_dir;  // --cache-dir: render result cache (empty = disabled)
+    uint64_t cache_max_mb = 1024;  // --cache-max-mb: render cache size limit
+    uint64_t image_cache_mb = 0;  // --image-cache-mb: decoded image budget (0 = decode all images up front)
+    bool profile_startup = false;  // --profile-startup: print startup phase timings to stderr
+    std::string font_dir;  // --font-dir: load fonts from this directory instead of fontconfig (empty = fontconfig)
     float text_padding = 0.97f;  // Text padding factor (0.0-1.0), default 0.97 (3% padding)
     TextMeasurementMode text_measurement_mode = TextMeasurementMode::ACCURATE;  // Text measurement mode
 };
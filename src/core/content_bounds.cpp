@@ -0,0 +1,127 @@
+#include "content_bounds.h"
+#include "../utils/logging.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <thread>
+
+// Full-resolution margin added around the low-resolution bounds: content touching a low-res pixel
+// edge can spill an anti-aliased fringe into a neighbour that stayed fully transparent
+static const int kBoundsMarginPixels = 2;
+
+// Bounds (in pre-pass pixels) of the non-transparent pixels of one frame, joined into bounds
+static void unionOpaqueBounds(const SkPixmap& pixmap, int& minX, int& minY, int& maxX, int& maxY) {
+    const int w = pixmap.width();
+    const int h = pixmap.height();
+    const uint8_t* base = static_cast<const uint8_t*>(pixmap.addr());
+    for (int y = 0; y < h; y++) {
+        // N32 is 4 bytes per pixel with alpha in the last byte (RGBA and BGRA alike)
+        const uint8_t* row = base + static_cast<size_t>(y) * pixmap.rowBytes();
+        int first = -1;
+        for (int x = 0; x < w; x++) {
+            if (row[x * 4 + 3] != 0) {
+                first = x;
+                break;
+            }
+        }
+        if (first < 0) {
+            continue;
+        }
+        int last = first;
+        for (int x = w - 1; x > first; x--) {
+            if (row[x * 4 + 3] != 0) {
+                last = x;
+                break;
+            }
+        }
+        minX = std::min(minX, first);
+        maxX = std::max(maxX, last);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+}
+
+SkIRect computeContentBounds(
+    const std::vector<sk_sp<skottie::Animation>>& animations,
+    const std::vector<float>& frame_times,
+    int width,
+    int height,
+    float prepassScale
+) {
+    const int num_threads = static_cast<int>(animations.size());
+    const int num_frames = static_cast<int>(frame_times.size());
+    const int prepass_width = std::max(1, static_cast<int>(std::ceil(width * prepassScale)));
+    const int prepass_height = std::max(1, static_cast<int>(std::ceil(height * prepassScale)));
+    LOG_DEBUG("Auto-trim pre-pass: " << num_frames << " frames at " << prepass_width << "x" << prepass_height);
+
+    struct ThreadBounds {
+        int minX = INT_MAX, minY = INT_MAX, maxX = -1, maxY = -1;
+    };
+    std::vector<ThreadBounds> thread_bounds(num_threads);
+
+    auto prepass_worker = [&](int thread_id) {
+        auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(prepass_width, prepass_height));
+        if (!surface) {
+            LOG_CERR("[ERROR] Failed to create auto-trim pre-pass surface") << std::endl;
+            return;
+        }
+        auto* canvas = surface->getCanvas();
+        canvas->scale(prepassScale, prepassScale);
+        SkPixmap pixmap;
+        auto& bounds = thread_bounds[thread_id];
+        for (int i = thread_id; i < num_frames; i += num_threads) {
+            canvas->clear(SK_ColorTRANSPARENT);
+            animations[thread_id]->seekFrameTime(frame_times[i]);
+            animations[thread_id]->render(canvas);
+            if (surface->peekPixels(&pixmap)) {
+                unionOpaqueBounds(pixmap, bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < num_threads; t++) {
+        workers.emplace_back(prepass_worker, t);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ThreadBounds total;
+    for (const auto& bounds : thread_bounds) {
+        total.minX = std::min(total.minX, bounds.minX);
+        total.minY = std::min(total.minY, bounds.minY);
+        total.maxX = std::max(total.maxX, bounds.maxX);
+        total.maxY = std::max(total.maxY, bounds.maxY);
+    }
+    if (total.maxX < 0 || total.maxY < 0) {
+        return SkIRect::MakeEmpty();
+    }
+
+    // Map pre-pass pixels back to canvas pixels, add the margin, clamp to the canvas
+    int left = std::max(0, static_cast<int>(std::floor(total.minX / prepassScale)) - kBoundsMarginPixels);
+    int top = std::max(0, static_cast<int>(std::floor(total.minY / prepassScale)) - kBoundsMarginPixels);
+    int right = std::min(width, static_cast<int>(std::ceil((total.maxX + 1) / prepassScale)) + kBoundsMarginPixels);
+    int bottom = std::min(height, static_cast<int>(std::ceil((total.maxY + 1) / prepassScale)) + kBoundsMarginPixels);
+
+    // Grow to even dimensions where the canvas allows it
+    if ((right - left) % 2 != 0) {
+        if (right < width) {
+            right++;
+        } else if (left > 0) {
+            left--;
+        }
+    }
+    if ((bottom - top) % 2 != 0) {
+        if (bottom < height) {
+            bottom++;
+        } else if (top > 0) {
+            top--;
+        }
+    }
+    return SkIRect::MakeLTRB(left, top, right, bottom);
+}
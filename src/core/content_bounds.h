@@ -0,0 +1,21 @@
+#ifndef CONTENT_BOUNDS_H
+#define CONTENT_BOUNDS_H
+
+#include <skia/modules/skottie/include/Skottie.h>
+#include <skia/core/SkRect.h>
+#include <vector>
+
+// Compute the union of non-transparent pixels over all frame times (auto-trim pre-pass)
+// Frames are rendered at prepassScale of the canvas size, spread across the given animations
+// (one thread per animation), and the result is mapped back to canvas coordinates with a
+// safety margin for anti-aliasing, then grown to even dimensions (YUV 4:2:0 encoders need them)
+// Returns an empty rect if no frame draws anything
+SkIRect computeContentBounds(
+    const std::vector<sk_sp<skottie::Animation>>& animations,
+    const std::vector<float>& frame_times,
+    int width,
+    int height,
+    float prepassScale = 0.25f
+);
+
+#endif // CONTENT_BOUNDS_H
@@ -15,7 +15,7 @@ EncodedFrame encodeFrame(sk_sp<SkImage> image) {
     
     // Encode to PNG (with faster compression)
     SkPngEncoder::Options png_options;
-    png_options.fZLibLevel = 1;  // Faster compression (was 6)
+    png_options.fZLibLevel = kPngZLibLevel;  // Faster compression (was 6)
     result.png_data = SkPngEncoder::Encode(nullptr, image.get(), png_options);
     result.has_png = (result.png_data != nullptr);
     
@@ -5,6 +5,9 @@
 #include "include/core/SkData.h"
 #include <string>
 
+// PNG zlib compression level used for all frames (part of the render cache key)
+constexpr int kPngZLibLevel = 1;
+
 // Frame encoding result
 struct EncodedFrame {
     sk_sp<SkData> png_data;
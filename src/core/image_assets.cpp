@@ -0,0 +1,413 @@
+#include "image_assets.h"
+#include "../utils/logging.h"
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkEncodedOrigin.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPixmapUtils.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <thread>
+
+// Decoding below this fraction of the full size is worth an extra resample
+static const float kMinDownscale = 0.9f;
+
+// Precomps and parent chains nest at most this deep (also guards against reference cycles)
+static const int kMaxNestingDepth = 32;
+
+// Track the larger absolute x/y scale of a Lottie scale value ([sx, sy, sz] in percent)
+static void considerScaleValue(const nlohmann::json& value, float& max_scale) {
+    if (value.is_array()) {
+        for (size_t i = 0; i < value.size() && i < 2; i++) {
+            if (value[i].is_number()) {
+                max_scale = std::max(max_scale, std::fabs(value[i].get<float>()) / 100.0f);
+            }
+        }
+    } else if (value.is_number()) {
+        max_scale = std::max(max_scale, std::fabs(value.get<float>()) / 100.0f);
+    }
+}
+
+// Largest scale a layer's own transform reaches over the animation (1.0 = 100%)
+// Returns a negative value when it cannot be known (scale driven by an expression)
+static float maxLayerScale(const nlohmann::json& layer) {
+    if (!layer.contains("ks") || !layer["ks"].is_object() || !layer["ks"].contains("s")) {
+        return 1.0f;
+    }
+    const auto& scale = layer["ks"]["s"];
+    if (!scale.is_object() || !scale.contains("k")) {
+        return 1.0f;
+    }
+    if (scale.contains("x")) {
+        return -1.0f;
+    }
+    float max_scale = 0.0f;
+    const auto& k = scale["k"];
+    if (k.is_array() && !k.empty() && k[0].is_object()) {
+        // Animated: keyframe start values ("s") and legacy end values ("e")
+        for (const auto& keyframe : k) {
+            if (keyframe.is_object()) {
+                if (keyframe.contains("s")) considerScaleValue(keyframe["s"], max_scale);
+                if (keyframe.contains("e")) considerScaleValue(keyframe["e"], max_scale);
+            }
+        }
+    } else {
+        considerScaleValue(k, max_scale);
+    }
+    return max_scale;
+}
+
+// Largest scale of a layer including its parent chain within the same composition
+static float maxLayerChainScale(const nlohmann::json& layers, const nlohmann::json& layer, int depth) {
+    float scale = maxLayerScale(layer);
+    if (scale < 0.0f || !layer.contains("parent") || !layer["parent"].is_number()) {
+        return scale;
+    }
+    if (depth > kMaxNestingDepth) {
+        return -1.0f;
+    }
+    const int parent_ind = layer["parent"].get<int>();
+    for (const auto& candidate : layers) {
+        if (candidate.is_object() && candidate.contains("ind") && candidate["ind"].is_number() &&
+            candidate["ind"].get<int>() == parent_ind) {
+            const float parent_scale = maxLayerChainScale(layers, candidate, depth + 1);
+            return parent_scale < 0.0f ? -1.0f : scale * parent_scale;
+        }
+    }
+    return scale;
+}
+
+// Record, per referenced asset id, the largest scale it is drawn at (negative = unknown)
+static void collectAssetScales(
+    const nlohmann::json& layers,
+    const std::map<std::string, const nlohmann::json*>& precomps,
+    float inherited_scale,
+    int depth,
+    std::map<std::string, float>& scales
+) {
+    if (!layers.is_array() || depth > kMaxNestingDepth) {
+        return;
+    }
+    for (const auto& layer : layers) {
+        if (!layer.is_object() || !layer.contains("refId") || !layer["refId"].is_string()) {
+            continue;
+        }
+        const float layer_scale = maxLayerChainScale(layers, layer, 0);
+        const float scale = (layer_scale < 0.0f || inherited_scale < 0.0f) ? -1.0f : layer_scale * inherited_scale;
+        const std::string ref_id = layer["refId"].get<std::string>();
+        auto precomp = precomps.find(ref_id);
+        if (precomp != precomps.end()) {
+            collectAssetScales((*precomp->second)["layers"], precomps, scale, depth + 1, scales);
+            continue;
+        }
+        auto it = scales.find(ref_id);
+        if (it == scales.end()) {
+            scales[ref_id] = scale;
+        } else if (it->second >= 0.0f) {
+            it->second = (scale < 0.0f) ? -1.0f : std::max(it->second, scale);
+        }
+    }
+}
+
+std::vector<ImageAssetRef> collectImageAssets(const SkData& json_data) {
+    std::vector<ImageAssetRef> assets;
+    try {
+        const char* begin = static_cast<const char*>(json_data.data());
+        nlohmann::json j = nlohmann::json::parse(begin, begin + json_data.size());
+        if (!j.contains("assets") || !j["assets"].is_array()) {
+            return assets;
+        }
+
+        std::map<std::string, const nlohmann::json*> precomps;
+        for (const auto& asset : j["assets"]) {
+            if (asset.is_object() && asset.contains("layers") && asset.contains("id") && asset["id"].is_string()) {
+                precomps[asset["id"].get<std::string>()] = &asset;
+            }
+        }
+        std::map<std::string, float> scales;
+        if (j.contains("layers")) {
+            collectAssetScales(j["layers"], precomps, 1.0f, 0, scales);
+        }
+
+        std::map<std::string, size_t> index_by_key;
+        for (const auto& asset : j["assets"]) {
+            // Precomp assets carry "layers" instead of an image file
+            if (!asset.is_object() || asset.contains("layers") || !asset.contains("p") || !asset["p"].is_string()) {
+                continue;
+            }
+            ImageAssetRef ref;
+            ref.name = asset["p"].get<std::string>();
+            ref.path = (asset.contains("u") && asset["u"].is_string()) ? asset["u"].get<std::string>() : "";
+            ref.id = (asset.contains("id") && asset["id"].is_string()) ? asset["id"].get<std::string>() : "";
+            if (ref.name.compare(0, 5, "data:") == 0) {
+                continue;
+            }
+
+            // Skottie fits the image into the asset w/h; without them it is drawn at its own size
+            const int w = (asset.contains("w") && asset["w"].is_number()) ? asset["w"].get<int>() : 0;
+            const int h = (asset.contains("h") && asset["h"].is_number()) ? asset["h"].get<int>() : 0;
+            auto scale = scales.find(ref.id);
+            bool known = w > 0 && h > 0 && scale != scales.end() && scale->second >= 0.0f;
+            if (known) {
+                ref.max_width = std::max(1, static_cast<int>(std::ceil(w * scale->second)));
+                ref.max_height = std::max(1, static_cast<int>(std::ceil(h * scale->second)));
+            }
+
+            // The same file under several ids: decode it once, at the largest size any of them needs
+            const std::string key = imageAssetKey(ref.path.c_str(), ref.name.c_str());
+            auto existing = index_by_key.find(key);
+            if (existing == index_by_key.end()) {
+                index_by_key[key] = assets.size();
+                ref.ids.push_back(ref.id);
+                assets.push_back(std::move(ref));
+                continue;
+            }
+            ImageAssetRef& merged = assets[existing->second];
+            merged.ids.push_back(ref.id);
+            if (!known || merged.max_width == 0) {
+                merged.max_width = 0;
+                merged.max_height = 0;
+            } else {
+                merged.max_width = std::max(merged.max_width, ref.max_width);
+                merged.max_height = std::max(merged.max_height, ref.max_height);
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        LOG_DEBUG("Failed to parse JSON for image asset scan: " << e.what());
+    }
+    return assets;
+}
+
+SkISize imageAssetDecodeSize(SkISize fullSize, int maxWidth, int maxHeight) {
+    if (maxWidth <= 0 || maxHeight <= 0 || fullSize.isEmpty()) {
+        return fullSize;
+    }
+    // Uniform scale so both drawn dimensions stay covered (Skottie keeps the aspect ratio)
+    const float scale = std::max(static_cast<float>(maxWidth) / fullSize.width(),
+                                 static_cast<float>(maxHeight) / fullSize.height());
+    if (scale >= kMinDownscale) {
+        return fullSize;
+    }
+    return SkISize::Make(std::max(1, static_cast<int>(std::ceil(fullSize.width() * scale))),
+                         std::max(1, static_cast<int>(std::ceil(fullSize.height() * scale))));
+}
+
+// Decode at target_size in the codec's stored orientation
+// Subsamples in the codec where supported (JPEG: 1/2, 1/4, 1/8), never below the target size
+static sk_sp<SkImage> decodeScaled(SkCodec& codec, SkISize full_size, SkISize target_size) {
+    SkISize decode_size = codec.getScaledDimensions(static_cast<float>(target_size.width()) / full_size.width());
+    if (decode_size.width() < target_size.width() || decode_size.height() < target_size.height()) {
+        decode_size = full_size;
+    }
+    const SkAlphaType alpha_type = codec.getInfo().isOpaque() ? kOpaque_SkAlphaType : kPremul_SkAlphaType;
+    SkImageInfo decode_info = SkImageInfo::MakeN32(decode_size.width(), decode_size.height(), alpha_type);
+    sk_sp<SkData> pixels = SkData::MakeUninitialized(decode_info.computeMinByteSize());
+    if (!pixels) {
+        return nullptr;
+    }
+    SkCodec::Result result = codec.getPixels(decode_info, pixels->writable_data(), decode_info.minRowBytes());
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput) {
+        return nullptr;
+    }
+    sk_sp<SkImage> image = SkImages::RasterFromData(decode_info, pixels, decode_info.minRowBytes());
+    if (!image || (decode_size.width() == target_size.width() && decode_size.height() == target_size.height())) {
+        return image;
+    }
+
+    // Resample the rest of the way once, instead of minifying the large image on every frame
+    SkImageInfo target_info = decode_info.makeDimensions(target_size);
+    sk_sp<SkData> target_pixels = SkData::MakeUninitialized(target_info.computeMinByteSize());
+    if (!target_pixels) {
+        return nullptr;
+    }
+    SkPixmap target_pixmap(target_info, target_pixels->writable_data(), target_info.minRowBytes());
+    if (!image->scalePixels(target_pixmap, SkSamplingOptions(SkCubicResampler::Mitchell()))) {
+        return image;
+    }
+    return SkImages::RasterFromData(target_info, target_pixels, target_info.minRowBytes());
+}
+
+// Rotate/mirror a raster image from its stored orientation to the EXIF origin's upright one
+static sk_sp<SkImage> applyEncodedOrigin(sk_sp<SkImage> image, SkEncodedOrigin origin) {
+    SkPixmap src;
+    if (!image || origin == kTopLeft_SkEncodedOrigin || !image->peekPixels(&src)) {
+        return image;
+    }
+    SkImageInfo info = SkEncodedOriginSwapsWidthHeight(origin) ? SkPixmapUtils::SwapWidthHeight(src.info())
+                                                               : src.info();
+    sk_sp<SkData> pixels = SkData::MakeUninitialized(info.computeMinByteSize());
+    if (!pixels) {
+        return nullptr;
+    }
+    SkPixmap dst(info, pixels->writable_data(), info.minRowBytes());
+    if (!SkPixmapUtils::Orient(dst, src, origin)) {
+        return nullptr;
+    }
+    return SkImages::RasterFromData(info, pixels, info.minRowBytes());
+}
+
+sk_sp<SkImage> decodeImageAsset(sk_sp<SkData> encoded, int maxWidth, int maxHeight) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(encoded);
+    if (!codec) {
+        return nullptr;
+    }
+    // maxWidth/maxHeight are drawn (upright) sizes; the codec decodes in the stored orientation,
+    // which is transposed for 90 degree EXIF origins
+    const SkEncodedOrigin origin = codec->getOrigin();
+    const bool swaps = SkEncodedOriginSwapsWidthHeight(origin);
+    const SkISize full_size = codec->dimensions();
+    SkISize target_size = swaps ? SkISize::Make(full_size.height(), full_size.width()) : full_size;
+    target_size = imageAssetDecodeSize(target_size, maxWidth, maxHeight);
+    if (swaps) {
+        target_size = SkISize::Make(target_size.height(), target_size.width());
+    }
+    if (target_size.width() == full_size.width() && target_size.height() == full_size.height()) {
+        // The codec image generator applies the origin itself
+        auto image = SkImages::DeferredFromEncodedData(std::move(encoded));
+        return image ? image->makeRasterImage() : nullptr;
+    }
+    return applyEncodedOrigin(decodeScaled(*codec, full_size, target_size), origin);
+}
+
+// Still image decoded by decodeImageAsset()
+class DecodedImageAsset final : public skresources::ImageAsset {
+public:
+    explicit DecodedImageAsset(sk_sp<SkImage> image) : fImage(std::move(image)) {}
+
+    bool isMultiFrame() override { return false; }
+
+    sk_sp<SkImage> getFrame(float) override { return fImage; }
+
+private:
+    sk_sp<SkImage> fImage;
+};
+
+std::string imageAssetKey(const char path[], const char name[]) {
+    return std::string(path ? path : "") + (name ? name : "");
+}
+
+sk_sp<SkImage> ScaledImageCache::get(const std::string& assetKey, int maxWidth, int maxHeight,
+                                     const std::function<sk_sp<SkImage>()>& decode) {
+    if (fAssetKeys.find(assetKey) == fAssetKeys.end()) {
+        return decode();
+    }
+    const auto key = std::make_tuple(assetKey, maxWidth, maxHeight);
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        auto it = fImages.find(key);
+        if (it != fImages.end()) {
+            LOG_DEBUG("[TEMPLATE] Reusing scaled base asset: " << assetKey << " (" << maxWidth << "x" << maxHeight << ")");
+            return it->second;
+        }
+    }
+    sk_sp<SkImage> image = decode();
+    std::lock_guard<std::mutex> lock(fMutex);
+    // Another thread may have decoded the same asset meanwhile; keep the first one
+    return fImages.emplace(key, std::move(image)).first->second;
+}
+
+PreDecodedResourceProvider::PreDecodedResourceProvider(sk_sp<skresources::ResourceProvider> wrapped)
+    : fWrapped(std::move(wrapped)) {}
+
+sk_sp<PreDecodedResourceProvider> PreDecodedResourceProvider::Make(
+    sk_sp<skresources::ResourceProvider> wrapped,
+    const std::vector<ImageAssetRef>& assets,
+    ScaledImageCache* scaledImages,
+    int maxThreads
+) {
+    sk_sp<PreDecodedResourceProvider> provider(new PreDecodedResourceProvider(std::move(wrapped)));
+    if (assets.empty()) {
+        return provider;
+    }
+
+    int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (hardware_threads <= 0) {
+        hardware_threads = 4;
+    }
+    const int num_threads = std::min(maxThreads > 0 ? maxThreads : hardware_threads,
+                                     static_cast<int>(assets.size()));
+    LOG_DEBUG("Pre-decoding " << assets.size() << " image assets on " << num_threads << " threads");
+    const auto start = std::chrono::steady_clock::now();
+
+    // Each slot is written by exactly one worker; the map is filled after all workers joined
+    std::vector<sk_sp<skresources::ImageAsset>> decoded(assets.size());
+    std::atomic<size_t> next_asset{0};
+    auto decode_worker = [&]() {
+        for (size_t i = next_asset++; i < assets.size(); i = next_asset++) {
+            const auto& ref = assets[i];
+            sk_sp<skresources::ImageAsset> asset;
+            if (ref.max_width > 0) {
+                // Known drawn size: decode still images straight to it
+                auto decode = [&]() -> sk_sp<SkImage> {
+                    auto encoded = provider->fWrapped->load(ref.path.c_str(), ref.name.c_str());
+                    auto codec = encoded ? SkCodec::MakeFromData(encoded) : nullptr;
+                    if (!codec || codec->getFrameCount() != 1) {
+                        return nullptr;
+                    }
+                    const SkISize full_size = codec->dimensions();
+                    codec.reset();
+                    auto image = decodeImageAsset(std::move(encoded), ref.max_width, ref.max_height);
+                    if (image && static_cast<int64_t>(image->width()) * image->height() !=
+                                 static_cast<int64_t>(full_size.width()) * full_size.height()) {
+                        LOG_DEBUG("Decoded " << ref.path << ref.name << " at " << image->width() << "x" << image->height()
+                                  << " (full size " << full_size.width() << "x" << full_size.height() << ")");
+                    }
+                    return image;
+                };
+                const std::string key = imageAssetKey(ref.path.c_str(), ref.name.c_str());
+                auto image = scaledImages ? scaledImages->get(key, ref.max_width, ref.max_height, decode) : decode();
+                if (image) {
+                    decoded[i] = sk_make_sp<DecodedImageAsset>(std::move(image));
+                    continue;
+                }
+            }
+            asset = provider->fWrapped->loadImageAsset(ref.path.c_str(), ref.name.c_str(), ref.id.c_str());
+            // kPreDecode assets decode on their first frame request; do it here, off the main thread
+            if (asset && !asset->getFrame(0)) {
+                LOG_CERR("[WARNING] Failed to decode image asset: " << ref.path << ref.name) << std::endl;
+            }
+            decoded[i] = std::move(asset);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < num_threads; t++) {
+        workers.emplace_back(decode_worker);
+    }
+    decode_worker();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < assets.size(); i++) {
+        if (decoded[i]) {
+            provider->fAssets[imageAssetKey(assets[i].path.c_str(), assets[i].name.c_str())] = std::move(decoded[i]);
+        }
+    }
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOG_DEBUG("Pre-decoded " << provider->fAssets.size() << "/" << assets.size() << " image assets in " << elapsed_ms << " ms");
+    return provider;
+}
+
+sk_sp<skresources::ImageAsset> PreDecodedResourceProvider::loadImageAsset(const char path[],
+                                                                        const char name[],
+                                                                        const char id[]) const {
+    auto it = fAssets.find(imageAssetKey(path, name));
+    if (it != fAssets.end()) {
+        return it->second;
+    }
+    // Not pre-decoded (failed above or not in assets[]): fall back to the regular path, which logs the failure
+    return fWrapped->loadImageAsset(path, name, id);
+}
+
+sk_sp<SkTypeface> PreDecodedResourceProvider::loadTypeface(const char name[], const char url[]) const {
+    return fWrapped->loadTypeface(name, url);
+}
+
+sk_sp<SkData> PreDecodedResourceProvider::load(const char path[], const char name[]) const {
+    return fWrapped->load(path, name);
+}
@@ -0,0 +1,89 @@
+#ifndef IMAGE_ASSETS_H
+#define IMAGE_ASSETS_H
+
+#include <skia/modules/skresources/include/SkResources.h>
+#include <skia/core/SkData.h>
+#include <skia/core/SkImage.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// An external image asset referenced by assets[] in a Lottie JSON
+// path/name are the "u"/"p" values Skottie passes to ResourceProvider::loadImageAsset()
+struct ImageAssetRef {
+    std::string path;
+    std::string name;
+    std::string id;
+    std::vector<std::string> ids;  // Every asset id referencing this file (id first)
+    // Largest size in output pixels the image is drawn at: asset w/h times the largest scale of
+    // the layers showing it (including parents and precomp layers). 0 = unknown (decode at full size)
+    int max_width = 0;
+    int max_height = 0;
+};
+
+// Collect the image assets referenced by the JSON, without duplicates
+// Precomp assets and embedded data URIs are skipped
+std::vector<ImageAssetRef> collectImageAssets(const SkData& json_data);
+
+// Size to decode an image of fullSize at so it still covers maxWidth x maxHeight
+// Aspect ratio is kept; returns fullSize when no meaningful reduction is possible
+SkISize imageAssetDecodeSize(SkISize fullSize, int maxWidth, int maxHeight);
+
+// Decode an encoded still image to a raster image of imageAssetDecodeSize()
+// Codecs that support it (JPEG, WebP) subsample while decoding; the rest is resampled.
+// The EXIF origin is applied, so maxWidth/maxHeight and the result are in upright orientation.
+sk_sp<SkImage> decodeImageAsset(sk_sp<SkData> encoded, int maxWidth, int maxHeight);
+
+// Key identifying an image asset across providers ("u" + "p", as Skottie resolves it)
+std::string imageAssetKey(const char path[], const char name[]);
+
+// Downscaled decodes of a fixed set of image assets (an animation template's base assets), kept
+// so every variant drawing a base image at the same size reuses one read and decode
+// Keyed by asset key and drawn size; results for other assets are not kept. Thread-safe.
+class ScaledImageCache : public SkRefCnt {
+public:
+    explicit ScaledImageCache(std::set<std::string> assetKeys) : fAssetKeys(std::move(assetKeys)) {}
+
+    // Image of an asset decoded for maxWidth x maxHeight: the cached one, or decode()'s result
+    // (decode runs without the lock; a null result, e.g. an animated image, is cached as well)
+    sk_sp<SkImage> get(const std::string& assetKey, int maxWidth, int maxHeight,
+                       const std::function<sk_sp<SkImage>()>& decode);
+
+private:
+    const std::set<std::string> fAssetKeys;
+    std::mutex fMutex;
+    std::map<std::tuple<std::string, int, int>, sk_sp<SkImage>> fImages;
+};
+
+// Resource provider that decodes a known set of image assets up front, in parallel, and then
+// serves loadImageAsset() from the decoded set. Assets outside the set are passed through.
+// Still images with a known drawn size are decoded at that size instead of their full resolution.
+class PreDecodedResourceProvider : public skresources::ResourceProvider {
+public:
+    // Load and decode assets on up to maxThreads threads (0 = hardware concurrency)
+    // scaledImages: reuse downscaled decodes across providers (null = decode every time)
+    static sk_sp<PreDecodedResourceProvider> Make(
+        sk_sp<skresources::ResourceProvider> wrapped,
+        const std::vector<ImageAssetRef>& assets,
+        ScaledImageCache* scaledImages = nullptr,
+        int maxThreads = 0
+    );
+
+    sk_sp<skresources::ImageAsset> loadImageAsset(const char path[],
+                                                   const char name[],
+                                                   const char id[]) const override;
+    sk_sp<SkTypeface> loadTypeface(const char name[], const char url[]) const override;
+    sk_sp<SkData> load(const char path[], const char name[]) const override;
+
+private:
+    explicit PreDecodedResourceProvider(sk_sp<skresources::ResourceProvider> wrapped);
+
+    sk_sp<skresources::ResourceProvider> fWrapped;
+    std::map<std::string, sk_sp<skresources::ImageAsset>> fAssets;  // Read-only after Make()
+};
+
+#endif // IMAGE_ASSETS_H
@@ -0,0 +1,349 @@
+#include "image_cache.h"
+#include "image_assets.h"
+#include "../utils/logging.h"
+#include "include/codec/SkCodec.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+// Assets whose layers are active within this many seconds of the playhead are prefetched and
+// evicted last (render threads work on neighbouring frames around the playhead)
+static const float kPrefetchWindowSeconds = 1.0f;
+
+// Precomps nest at most this deep (also guards against reference cycles)
+static const int kMaxPrecompDepth = 16;
+
+static float jsonNumber(const nlohmann::json& object, const char* field, float fallback) {
+    auto it = object.find(field);
+    return (it != object.end() && it->is_number()) ? it->get<float>() : fallback;
+}
+
+// Walk layers, recording in frames on the root timeline when each image asset may be drawn
+// offset: root-timeline frame of the composition's frame 0; [window_in, window_out): frames the
+// parent layer is active; whole_window: nested timing is unknown (time remap or stretch)
+static void collectLayerRanges(
+    const nlohmann::json& layers,
+    const std::map<std::string, const nlohmann::json*>& precomps,
+    float offset,
+    float window_in,
+    float window_out,
+    bool whole_window,
+    int depth,
+    std::map<std::string, std::vector<AssetTimeRange>>& ranges
+) {
+    if (!layers.is_array() || depth > kMaxPrecompDepth) {
+        return;
+    }
+    for (const auto& layer : layers) {
+        if (!layer.is_object() || !layer.contains("refId") || !layer["refId"].is_string()) {
+            continue;
+        }
+        float in = window_in;
+        float out = window_out;
+        if (!whole_window) {
+            in = std::max(window_in, offset + jsonNumber(layer, "ip", window_in - offset));
+            out = std::min(window_out, offset + jsonNumber(layer, "op", window_out - offset));
+        }
+        if (in >= out) {
+            continue;
+        }
+
+        const std::string ref_id = layer["refId"].get<std::string>();
+        auto precomp = precomps.find(ref_id);
+        if (precomp != precomps.end()) {
+            const bool nested_whole = whole_window || layer.contains("tm") || jsonNumber(layer, "sr", 1.0f) != 1.0f;
+            collectLayerRanges((*precomp->second)["layers"], precomps, offset + jsonNumber(layer, "st", 0.0f),
+                               in, out, nested_whole, depth + 1, ranges);
+        } else {
+            ranges[ref_id].push_back({in, out});
+        }
+    }
+}
+
+std::map<std::string, std::vector<AssetTimeRange>> collectImageAssetTimeRanges(const SkData& json_data) {
+    std::map<std::string, std::vector<AssetTimeRange>> ranges;
+    try {
+        const char* begin = static_cast<const char*>(json_data.data());
+        nlohmann::json j = nlohmann::json::parse(begin, begin + json_data.size());
+
+        std::map<std::string, const nlohmann::json*> precomps;
+        if (j.contains("assets") && j["assets"].is_array()) {
+            for (const auto& asset : j["assets"]) {
+                if (asset.is_object() && asset.contains("layers") && asset.contains("id") && asset["id"].is_string()) {
+                    precomps[asset["id"].get<std::string>()] = &asset;
+                }
+            }
+        }
+
+        const float fr = jsonNumber(j, "fr", 30.0f);
+        const float ip = jsonNumber(j, "ip", 0.0f);
+        const float op = jsonNumber(j, "op", ip);
+        if (j.contains("layers") && fr > 0.0f) {
+            collectLayerRanges(j["layers"], precomps, 0.0f, ip, op, false, 0, ranges);
+        }
+        // Frames to seconds; renderer times are relative to the animation in-point
+        for (auto& asset_ranges : ranges) {
+            for (auto& range : asset_ranges.second) {
+                range.start = (range.start - ip) / fr;
+                range.end = (range.end - ip) / fr;
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        LOG_DEBUG("Failed to parse JSON for image asset time ranges: " << e.what());
+    }
+    return ranges;
+}
+
+ImageAssetCache::ImageAssetCache(size_t budgetBytes) : fBudgetBytes(budgetBytes) {}
+
+ImageAssetCache::~ImageAssetCache() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fPrefetchCv.notify_all();
+    if (fPrefetchThread.joinable()) {
+        fPrefetchThread.join();
+    }
+}
+
+int ImageAssetCache::addAsset(const std::string& key, sk_sp<SkData> encoded, int maxWidth, int maxHeight,
+                              size_t estimatedBytes, std::vector<AssetTimeRange> ranges) {
+    auto entry = std::make_unique<Entry>();
+    entry->key = key;
+    entry->encoded = std::move(encoded);
+    entry->max_width = maxWidth;
+    entry->max_height = maxHeight;
+    entry->estimated_bytes = estimatedBytes;
+    entry->ranges = std::move(ranges);
+    fEntries.push_back(std::move(entry));
+    return static_cast<int>(fEntries.size() - 1);
+}
+
+void ImageAssetCache::startPrefetch() {
+    if (!fEntries.empty() && !fPrefetchThread.joinable()) {
+        fPrefetchThread = std::thread(&ImageAssetCache::prefetchLoop, this);
+    }
+}
+
+sk_sp<SkImage> ImageAssetCache::acquire(int index) {
+    Entry& entry = *fEntries[index];
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (entry.image) {
+            entry.last_use = ++fUseClock;
+            return entry.image;
+        }
+    }
+
+    // Decode outside the cache lock; the per-entry lock makes concurrent requests wait for one decode
+    std::lock_guard<std::mutex> decode_lock(entry.decode_mutex);
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (entry.image) {
+            entry.last_use = ++fUseClock;
+            return entry.image;
+        }
+    }
+    sk_sp<SkImage> image = decodeImageAsset(entry.encoded, entry.max_width, entry.max_height);
+    if (!image) {
+        LOG_CERR("[WARNING] Failed to decode image asset: " << entry.key) << std::endl;
+        return nullptr;
+    }
+    LOG_DEBUG("[IMAGE CACHE] Decoded " << entry.key << " (" << image->width() << "x" << image->height() << ")");
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    entry.image = image;
+    entry.bytes = static_cast<size_t>(image->width()) * static_cast<size_t>(image->height()) * 4;
+    entry.last_use = ++fUseClock;
+    fResidentBytes += entry.bytes;
+    evictLocked(&entry);
+    return image;
+}
+
+void ImageAssetCache::setPlayhead(float seconds) {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (fPlayhead == seconds) {
+            return;
+        }
+        fPlayhead = seconds;
+    }
+    fPrefetchCv.notify_one();
+}
+
+size_t ImageAssetCache::residentBytes() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fResidentBytes;
+}
+
+bool ImageAssetCache::isNearPlayhead(const Entry& entry, float playhead) const {
+    for (const auto& range : entry.ranges) {
+        if (range.start <= playhead + kPrefetchWindowSeconds && playhead - kPrefetchWindowSeconds < range.end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ImageAssetCache::evictLocked(const Entry* keep) {
+    while (fResidentBytes > fBudgetBytes) {
+        // Least recently used first, preferring assets whose layers are not active around the playhead
+        // Only images the cache holds exclusively: dropping an image an animation still references
+        // frees nothing, and the next acquire() would decode a second copy next to it
+        Entry* victim = nullptr;
+        bool victim_near = true;
+        for (auto& candidate : fEntries) {
+            if (!candidate->image || candidate.get() == keep || !candidate->image->unique()) {
+                continue;
+            }
+            const bool near = isNearPlayhead(*candidate, fPlayhead);
+            if (!victim || (victim_near && !near) ||
+                (victim_near == near && candidate->last_use < victim->last_use)) {
+                victim = candidate.get();
+                victim_near = near;
+            }
+        }
+        if (!victim) {
+            if (!fWarnedOverBudget) {
+                LOG_CERR("[WARNING] Image cache budget (" << (fBudgetBytes / (1024 * 1024)) << " MB) is smaller than "
+                         << "the images the animations still reference; exceeding it") << std::endl;
+                fWarnedOverBudget = true;
+            }
+            return;
+        }
+        // The cache held the only reference, so the pixels are freed here
+        LOG_DEBUG("[IMAGE CACHE] Evicting " << victim->key);
+        victim->image.reset();
+        fResidentBytes -= victim->bytes;
+        victim->bytes = 0;
+    }
+}
+
+void ImageAssetCache::prefetchLoop() {
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (true) {
+        fPrefetchCv.wait(lock, [this]() { return fStopping || fPlayhead != fPrefetchedPlayhead; });
+        if (fStopping) {
+            return;
+        }
+        const float playhead = fPlayhead;
+        fPrefetchedPlayhead = playhead;
+
+        // Upcoming assets, soonest first, that fit next to the assets needed around the playhead
+        size_t near_bytes = 0;
+        std::vector<std::pair<float, int>> upcoming;
+        for (size_t i = 0; i < fEntries.size(); i++) {
+            const Entry& entry = *fEntries[i];
+            if (!isNearPlayhead(entry, playhead)) {
+                if (entry.image && !entry.image->unique()) {
+                    near_bytes += entry.bytes;  // Still referenced by an animation: cannot be evicted
+                }
+                continue;
+            }
+            if (entry.image) {
+                near_bytes += entry.bytes;
+                continue;
+            }
+            float start = entry.ranges.front().start;
+            for (const auto& range : entry.ranges) {
+                if (range.end > playhead) {
+                    start = std::min(start, std::max(range.start, playhead));
+                }
+            }
+            upcoming.emplace_back(start, static_cast<int>(i));
+        }
+        std::sort(upcoming.begin(), upcoming.end());
+
+        for (const auto& item : upcoming) {
+            const Entry& entry = *fEntries[item.second];
+            if (fStopping || near_bytes + entry.estimated_bytes > fBudgetBytes) {
+                break;
+            }
+            near_bytes += entry.estimated_bytes;
+            lock.unlock();
+            acquire(item.second);
+            lock.lock();
+        }
+    }
+}
+
+// Image asset backed by the cache
+// Reported as multi-frame so Skottie asks for the image on every seek while the layer is active
+// instead of resolving it once. The layer's image node still keeps the last image returned after
+// the layer ends, until the animation is destroyed; the cache keeps such images resident.
+class LazyImageAsset final : public skresources::ImageAsset {
+public:
+    LazyImageAsset(sk_sp<ImageAssetCache> cache, int index) : fCache(std::move(cache)), fIndex(index) {}
+
+    bool isMultiFrame() override { return true; }
+
+    sk_sp<SkImage> getFrame(float) override { return fCache->acquire(fIndex); }
+
+private:
+    sk_sp<ImageAssetCache> fCache;
+    int fIndex;
+};
+
+LazyImageResourceProvider::LazyImageResourceProvider(sk_sp<skresources::ResourceProvider> wrapped,
+                                                     sk_sp<ImageAssetCache> cache)
+    : fWrapped(std::move(wrapped)), fCache(std::move(cache)) {}
+
+sk_sp<LazyImageResourceProvider> LazyImageResourceProvider::Make(
+    sk_sp<skresources::ResourceProvider> wrapped,
+    const SkData& json_data,
+    const std::vector<ImageAssetRef>& assets,
+    size_t budgetBytes
+) {
+    auto cache = sk_make_sp<ImageAssetCache>(budgetBytes);
+    sk_sp<LazyImageResourceProvider> provider(new LazyImageResourceProvider(std::move(wrapped), cache));
+
+    auto time_ranges = collectImageAssetTimeRanges(json_data);
+    size_t total_bytes = 0;
+    for (const auto& ref : assets) {
+        auto encoded = provider->fWrapped->load(ref.path.c_str(), ref.name.c_str());
+        auto codec = encoded ? SkCodec::MakeFromData(encoded) : nullptr;
+        if (!codec || codec->getFrameCount() > 1) {
+            continue;  // Missing (logged by the wrapped provider later) or animated: pass through
+        }
+        const SkISize decode_size = imageAssetDecodeSize(codec->dimensions(), ref.max_width, ref.max_height);
+        const size_t estimated_bytes = static_cast<size_t>(decode_size.width()) *
+                                       static_cast<size_t>(decode_size.height()) * 4;
+        total_bytes += estimated_bytes;
+
+        // Layers may draw the file under any of the ids that reference it
+        std::vector<AssetTimeRange> ranges;
+        for (const auto& id : ref.ids) {
+            auto it = time_ranges.find(id);
+            if (it != time_ranges.end()) {
+                ranges.insert(ranges.end(), it->second.begin(), it->second.end());
+            }
+        }
+        const std::string key = imageAssetKey(ref.path.c_str(), ref.name.c_str());
+        int index = cache->addAsset(key, std::move(encoded), ref.max_width, ref.max_height,
+                                    estimated_bytes, std::move(ranges));
+        provider->fAssets[key] = sk_make_sp<LazyImageAsset>(cache, index);
+    }
+    LOG_DEBUG("Image cache: " << provider->fAssets.size() << " assets, " << (total_bytes / (1024 * 1024))
+              << " MB decoded in total, budget " << (budgetBytes / (1024 * 1024)) << " MB");
+
+    cache->startPrefetch();
+    return provider;
+}
+
+sk_sp<skresources::ImageAsset> LazyImageResourceProvider::loadImageAsset(const char path[],
+                                                                       const char name[],
+                                                                       const char id[]) const {
+    auto it = fAssets.find(imageAssetKey(path, name));
+    if (it != fAssets.end()) {
+        return it->second;
+    }
+    return fWrapped->loadImageAsset(path, name, id);
+}
+
+sk_sp<SkTypeface> LazyImageResourceProvider::loadTypeface(const char name[], const char url[]) const {
+    return fWrapped->loadTypeface(name, url);
+}
+
+sk_sp<SkData> LazyImageResourceProvider::load(const char path[], const char name[]) const {
+    return fWrapped->load(path, name);
+}
@@ -0,0 +1,119 @@
+#ifndef IMAGE_CACHE_H
+#define IMAGE_CACHE_H
+
+#include <skia/modules/skresources/include/SkResources.h>
+#include <skia/core/SkData.h>
+#include <skia/core/SkImage.h>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ImageAssetRef;
+
+// Time range (seconds on the root timeline) during which a layer may draw an image asset
+struct AssetTimeRange {
+    float start;
+    float end;
+};
+
+// Collect, per image asset id, the time ranges of the layers that draw it (from layer ip/op,
+// following precomp layers and their start offsets). Time-remapped or stretched precomps
+// conservatively count as drawing their images for their whole active range.
+std::map<std::string, std::vector<AssetTimeRange>> collectImageAssetTimeRanges(const SkData& json_data);
+
+// Decoded image pixels under a byte budget
+// Assets are decoded on first use and evicted least recently used first, preferring assets whose
+// layers are not active around the playhead. A background thread decodes assets whose layers
+// become active shortly after the playhead, as long as they fit in the budget.
+// Only images the cache holds exclusively are evicted: Skottie's image nodes keep the last image
+// their layer drew, so an image stays resident (and counts against the budget) until no
+// animation references it; its pixels are freed when the cache then evicts it.
+class ImageAssetCache : public SkRefCnt {
+public:
+    explicit ImageAssetCache(size_t budgetBytes);
+    ~ImageAssetCache() override;
+
+    // Register an asset by its encoded bytes; returns the index used by acquire()
+    // maxWidth/maxHeight: largest drawn size to decode at (0 = full size)
+    // estimatedBytes: decoded size from the codec header (used to plan prefetches)
+    int addAsset(const std::string& key, sk_sp<SkData> encoded, int maxWidth, int maxHeight,
+                 size_t estimatedBytes, std::vector<AssetTimeRange> ranges);
+
+    // Start the prefetch thread (call once, after all assets are registered)
+    void startPrefetch();
+
+    // Decoded image of an asset, decoding it now if it is not resident
+    sk_sp<SkImage> acquire(int index);
+
+    // Report the time (seconds) of the frame about to be rendered
+    void setPlayhead(float seconds);
+
+    // Decoded bytes held by the cache, including images animations still reference
+    size_t residentBytes() const;
+
+private:
+    struct Entry {
+        std::string key;
+        sk_sp<SkData> encoded;
+        int max_width = 0;
+        int max_height = 0;
+        size_t estimated_bytes = 0;
+        std::vector<AssetTimeRange> ranges;
+        sk_sp<SkImage> image;           // Resident pixels (null when evicted or not decoded yet)
+        size_t bytes = 0;
+        uint64_t last_use = 0;
+        std::mutex decode_mutex;        // Serializes decodes of this asset
+    };
+
+    bool isNearPlayhead(const Entry& entry, float playhead) const;
+    void evictLocked(const Entry* keep);
+    void prefetchLoop();
+
+    const size_t fBudgetBytes;
+    std::vector<std::unique_ptr<Entry>> fEntries;
+    mutable std::mutex fMutex;           // Guards resident state, LRU clock and playhead
+    std::condition_variable fPrefetchCv;
+    size_t fResidentBytes = 0;
+    uint64_t fUseClock = 0;
+    float fPlayhead = 0.0f;
+    float fPrefetchedPlayhead = -1.0f;  // Playhead the prefetch thread last planned for
+    bool fStopping = false;
+    bool fWarnedOverBudget = false;
+    std::thread fPrefetchThread;
+};
+
+// Resource provider that serves image assets from an ImageAssetCache
+// Encoded bytes come from the wrapped provider's load(); animated (multi-frame) images and
+// assets that cannot be loaded this way are passed through to the wrapped provider.
+class LazyImageResourceProvider : public skresources::ResourceProvider {
+public:
+    // assets: the image assets json_data references (collectImageAssets())
+    static sk_sp<LazyImageResourceProvider> Make(
+        sk_sp<skresources::ResourceProvider> wrapped,
+        const SkData& json_data,
+        const std::vector<ImageAssetRef>& assets,
+        size_t budgetBytes
+    );
+
+    const sk_sp<ImageAssetCache>& cache() const { return fCache; }
+
+    sk_sp<skresources::ImageAsset> loadImageAsset(const char path[],
+                                                   const char name[],
+                                                   const char id[]) const override;
+    sk_sp<SkTypeface> loadTypeface(const char name[], const char url[]) const override;
+    sk_sp<SkData> load(const char path[], const char name[]) const override;
+
+private:
+    LazyImageResourceProvider(sk_sp<skresources::ResourceProvider> wrapped, sk_sp<ImageAssetCache> cache);
+
+    sk_sp<skresources::ResourceProvider> fWrapped;
+    sk_sp<ImageAssetCache> fCache;
+    std::map<std::string, sk_sp<skresources::ImageAsset>> fAssets;  // Read-only after Make()
+};
+
+#endif // IMAGE_CACHE_H
@@ -0,0 +1,254 @@
+#include "pixel_convert.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOTIO_HAS_AVX2_KERNEL 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LOTIO_HAS_NEON_KERNEL 1
+#endif
+
+// Reciprocal table: unpremul(c, a) = (c * kReciprocal[a] + 0x8000) >> 16 == round(c * 255 / a)
+// (exact .5 ties may round down; every kernel produces identical results)
+// c * kReciprocal[a] + 0x8000 fits in 32 bits for every c, a <= 255; kReciprocal[0] = 0 maps
+// fully transparent pixels to transparent black
+namespace {
+
+struct ReciprocalTable {
+    uint32_t values[256];
+
+    ReciprocalTable() {
+        values[0] = 0;
+        for (uint32_t a = 1; a < 256; a++) {
+            values[a] = (255u * 65536u + a / 2) / a;
+        }
+    }
+};
+
+const ReciprocalTable& reciprocalTable() {
+    static const ReciprocalTable table;
+    return table;
+}
+
+inline uint32_t unpremulChannel(uint32_t c, uint32_t reciprocal) {
+    return std::min<uint32_t>((c * reciprocal + 0x8000u) >> 16, 255u);
+}
+
+void unpremultiplyRowScalar(const uint8_t* src, uint8_t* dst, int width, bool swapRB, const uint32_t* table) {
+    for (int x = 0; x < width; x++) {
+        const uint8_t c0 = src[x * 4 + 0];
+        const uint8_t c1 = src[x * 4 + 1];
+        const uint8_t c2 = src[x * 4 + 2];
+        const uint8_t a = src[x * 4 + 3];
+        const uint32_t reciprocal = table[a];
+        const uint8_t o0 = static_cast<uint8_t>(a == 255 ? c0 : unpremulChannel(c0, reciprocal));
+        const uint8_t o1 = static_cast<uint8_t>(a == 255 ? c1 : unpremulChannel(c1, reciprocal));
+        const uint8_t o2 = static_cast<uint8_t>(a == 255 ? c2 : unpremulChannel(c2, reciprocal));
+        dst[x * 4 + 0] = swapRB ? o2 : o0;
+        dst[x * 4 + 1] = o1;
+        dst[x * 4 + 2] = swapRB ? o0 : o2;
+        dst[x * 4 + 3] = a;
+    }
+}
+
+// Any non-zero alpha in columns [x0, x0 + count) of any row
+bool columnsCoveredScalar(const uint8_t* pixels, size_t rowBytes, int x0, int count, int height) {
+    for (int y = 0; y < height; y++) {
+        const uint32_t* row = reinterpret_cast<const uint32_t*>(pixels + static_cast<size_t>(y) * rowBytes) + x0;
+        for (int i = 0; i < count; i++) {
+            if (row[i] >> 24) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+
+__attribute__((target("avx2")))
+void unpremultiplyRowAVX2(const uint8_t* src, uint8_t* dst, int width, bool swapRB, const uint32_t* table) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i rounding = _mm256_set1_epi32(0x8000);
+    const __m256i maxChannel = _mm256_set1_epi32(0xFF);
+    const __m256i swapShuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                                 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+
+        // Opaque run: nothing to unpremultiply
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(px, alphaMask), alphaMask)) == -1) {
+            if (swapRB) {
+                px = _mm256_shuffle_epi8(px, swapShuffle);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), px);
+            continue;
+        }
+
+        const __m256i alpha = _mm256_srli_epi32(px, 24);
+        const __m256i reciprocal = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), alpha, 4);
+
+        __m256i c0 = _mm256_and_si256(px, byteMask);
+        __m256i c1 = _mm256_and_si256(_mm256_srli_epi32(px, 8), byteMask);
+        __m256i c2 = _mm256_and_si256(_mm256_srli_epi32(px, 16), byteMask);
+        c0 = _mm256_min_epu32(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c0, reciprocal), rounding), 16), maxChannel);
+        c1 = _mm256_min_epu32(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c1, reciprocal), rounding), 16), maxChannel);
+        c2 = _mm256_min_epu32(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c2, reciprocal), rounding), 16), maxChannel);
+
+        if (swapRB) {
+            std::swap(c0, c2);
+        }
+        __m256i out = _mm256_or_si256(_mm256_and_si256(px, alphaMask),
+                      _mm256_or_si256(c0,
+                      _mm256_or_si256(_mm256_slli_epi32(c1, 8), _mm256_slli_epi32(c2, 16))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+    }
+    unpremultiplyRowScalar(src + x * 4, dst + x * 4, width - x, swapRB, table);
+}
+
+// Any non-zero alpha in columns [x0, x0 + 8) of any row
+__attribute__((target("avx2")))
+bool columnsCoveredAVX2(const uint8_t* pixels, size_t rowBytes, int x0, int height) {
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    __m256i coverage = _mm256_setzero_si256();
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * rowBytes + static_cast<size_t>(x0) * 4;
+        coverage = _mm256_or_si256(coverage, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+    }
+    return !_mm256_testz_si256(coverage, alphaMask);
+}
+
+bool cpuHasAVX2() {
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+}
+
+#endif  // LOTIO_HAS_AVX2_KERNEL
+
+#if defined(LOTIO_HAS_NEON_KERNEL)
+
+// c (u8 x 8) * reciprocal (u32 x 8, as lo/hi halves) -> rounded, saturated u8 x 8
+inline uint8x8_t unpremulChannelsNEON(uint8x8_t c, uint32x4_t reciprocalLo, uint32x4_t reciprocalHi) {
+    const uint16x8_t wide = vmovl_u8(c);
+    uint32x4_t lo = vmulq_u32(vmovl_u16(vget_low_u16(wide)), reciprocalLo);
+    uint32x4_t hi = vmulq_u32(vmovl_u16(vget_high_u16(wide)), reciprocalHi);
+    lo = vshrq_n_u32(vaddq_u32(lo, vdupq_n_u32(0x8000)), 16);
+    hi = vshrq_n_u32(vaddq_u32(hi, vdupq_n_u32(0x8000)), 16);
+    return vqmovn_u16(vcombine_u16(vqmovn_u32(lo), vqmovn_u32(hi)));
+}
+
+void unpremultiplyRowNEON(const uint8_t* src, uint8_t* dst, int width, bool swapRB, const uint32_t* table) {
+    int x = 0;
+    uint32_t reciprocal[8];
+    for (; x + 8 <= width; x += 8) {
+        // De-interleave 8 pixels into channel planes
+        uint8x8x4_t px = vld4_u8(src + x * 4);
+
+        uint8_t alpha[8];
+        vst1_u8(alpha, px.val[3]);
+        if (vminv_u8(px.val[3]) != 255) {
+            for (int i = 0; i < 8; i++) {
+                reciprocal[i] = table[alpha[i]];
+            }
+            const uint32x4_t reciprocalLo = vld1q_u32(reciprocal);
+            const uint32x4_t reciprocalHi = vld1q_u32(reciprocal + 4);
+            px.val[0] = unpremulChannelsNEON(px.val[0], reciprocalLo, reciprocalHi);
+            px.val[1] = unpremulChannelsNEON(px.val[1], reciprocalLo, reciprocalHi);
+            px.val[2] = unpremulChannelsNEON(px.val[2], reciprocalLo, reciprocalHi);
+        }
+        if (swapRB) {
+            const uint8x8_t tmp = px.val[0];
+            px.val[0] = px.val[2];
+            px.val[2] = tmp;
+        }
+        vst4_u8(dst + x * 4, px);
+    }
+    unpremultiplyRowScalar(src + x * 4, dst + x * 4, width - x, swapRB, table);
+}
+
+// Any non-zero alpha in columns [x0, x0 + 8) of any row
+bool columnsCoveredNEON(const uint8_t* pixels, size_t rowBytes, int x0, int height) {
+    uint32x4_t coverage = vdupq_n_u32(0);
+    for (int y = 0; y < height; y++) {
+        const uint32_t* row = reinterpret_cast<const uint32_t*>(pixels + static_cast<size_t>(y) * rowBytes) + x0;
+        coverage = vorrq_u32(coverage, vorrq_u32(vld1q_u32(row), vld1q_u32(row + 4)));
+    }
+    return vmaxvq_u32(vshrq_n_u32(coverage, 24)) != 0;
+}
+
+#endif  // LOTIO_HAS_NEON_KERNEL
+
+}  // namespace
+
+void unpremultiplyPixels(
+    const uint8_t* src,
+    size_t srcRowBytes,
+    uint8_t* dst,
+    size_t dstRowBytes,
+    int width,
+    int height,
+    bool swapRB
+) {
+    const uint32_t* table = reciprocalTable().values;
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+    const bool useAVX2 = cpuHasAVX2();
+#endif
+    for (int y = 0; y < height; y++) {
+        const uint8_t* srcRow = src + static_cast<size_t>(y) * srcRowBytes;
+        uint8_t* dstRow = dst + static_cast<size_t>(y) * dstRowBytes;
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+        if (useAVX2) {
+            unpremultiplyRowAVX2(srcRow, dstRow, width, swapRB, table);
+        } else {
+            unpremultiplyRowScalar(srcRow, dstRow, width, swapRB, table);
+        }
+#elif defined(LOTIO_HAS_NEON_KERNEL)
+        unpremultiplyRowNEON(srcRow, dstRow, width, swapRB, table);
+#else
+        unpremultiplyRowScalar(srcRow, dstRow, width, swapRB, table);
+#endif
+    }
+}
+
+const char* unpremultiplyKernelName() {
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+    return cpuHasAVX2() ? "avx2" : "scalar";
+#elif defined(LOTIO_HAS_NEON_KERNEL)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+int rightmostCoveredColumn(const uint8_t* pixels, size_t rowBytes, int width, int height, int startX) {
+    startX = std::max(startX, 0);
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+    const bool useAVX2 = cpuHasAVX2();
+#endif
+    int x = width;
+    for (; x - 8 >= startX; x -= 8) {
+#if defined(LOTIO_HAS_AVX2_KERNEL)
+        const bool covered = useAVX2 ? columnsCoveredAVX2(pixels, rowBytes, x - 8, height)
+                                     : columnsCoveredScalar(pixels, rowBytes, x - 8, 8, height);
+#elif defined(LOTIO_HAS_NEON_KERNEL)
+        const bool covered = columnsCoveredNEON(pixels, rowBytes, x - 8, height);
+#else
+        const bool covered = columnsCoveredScalar(pixels, rowBytes, x - 8, 8, height);
+#endif
+        if (covered) {
+            break;  // The rightmost covered column is in this block
+        }
+    }
+    // Locate the column in the covered block (or the partial block left of the full ones)
+    for (int column = x - 1; column >= startX; column--) {
+        if (columnsCoveredScalar(pixels, rowBytes, column, 1, height)) {
+            return column;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,30 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Convert premultiplied 32-bit pixels (8-bit channels, alpha in the last byte: RGBA or BGRA)
+// to unpremultiplied, optionally swapping the R and B channels for the output format
+// Uses a reciprocal table (no per-pixel division); AVX2 or NEON when available, scalar otherwise
+// src and dst may be the same buffer (in-place conversion)
+void unpremultiplyPixels(
+    const uint8_t* src,
+    size_t srcRowBytes,
+    uint8_t* dst,
+    size_t dstRowBytes,
+    int width,
+    int height,
+    bool swapRB
+);
+
+// Name of the kernel selected for this CPU ("avx2", "neon" or "scalar"), for logging/benchmarks
+const char* unpremultiplyKernelName();
+
+// Rightmost column in [startX, width) of 32-bit pixels (alpha in the high byte of each
+// native-endian pixel, as N32) where any row has a non-zero alpha; -1 if all are transparent
+// Scans blocks of 8 columns from the right across all rows and stops at the first covered block
+// (AVX2 or NEON when available, scalar otherwise)
+int rightmostCoveredColumn(const uint8_t* pixels, size_t rowBytes, int width, int height, int startX);
+
+#endif // PIXEL_CONVERT_H
@@ -0,0 +1,163 @@
+#include "render_cache.h"
+#include "frame_encoder.h"
+#include "../text/font_service.h"
+#include "../utils/logging.h"
+#include "../utils/sha256.h"
+#include "../utils/version.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+// Bump when the cache layout or key composition changes
+static const char* kRenderCacheFormat = "render-cache-v3";
+
+std::string cachedFramePath(const std::string& dir, int frame_idx) {
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%05d.png", frame_idx);
+    return (fs::path(dir) / name).string();
+}
+
+// Hash the bytes of every external image the JSON references (embedded data URIs are already
+// part of the JSON bytes). Overrides can keep a path while the file changes on disk.
+static void hashReferencedImages(Sha256& hasher, const std::vector<ImageAssetRef>& image_assets,
+                                 const std::string& asset_base_dir) {
+    std::vector<char> buffer(64 * 1024);
+    for (const auto& asset : image_assets) {
+        // Skia's FileResourceProvider joins base_dir, u and p
+        fs::path imagePath = fs::path(asset_base_dir) / asset.path / asset.name;
+
+        hasher.update(imagePath.string());
+        std::ifstream file(imagePath, std::ios::binary);
+        if (!file.is_open()) {
+            hasher.update("<missing>");
+            continue;
+        }
+        while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+            hasher.update(buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+    }
+}
+
+std::string computeRenderCacheKey(
+    const SkData& json_data,
+    const std::vector<ImageAssetRef>& image_assets,
+    const std::string& asset_base_dir,
+    int width,
+    int height,
+    float fps,
+    const std::vector<float>& frame_times,
+    const std::string& output_options
+) {
+    Sha256 hasher;
+    std::string header = std::string(kRenderCacheFormat) +
+                         "|version=" + getLotioVersion() +
+                         "|encoder=png,zlib=" + std::to_string(kPngZLibLevel) +
+                         "|size=" + std::to_string(width) + "x" + std::to_string(height) +
+                         "|fps=" + std::to_string(fps) +
+                         "|frames=" + std::to_string(frame_times.size()) +
+                         "|options=" + output_options +
+                         "|fonts=" + fontConfigurationSignature() +
+                         "|json=" + std::to_string(json_data.size()) + "|";
+    hasher.update(header);
+    hasher.update(frame_times.data(), frame_times.size() * sizeof(float));
+    hasher.update(json_data.data(), json_data.size());
+    hashReferencedImages(hasher, image_assets, asset_base_dir);
+    return hasher.hexDigest();
+}
+
+static bool readFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    data.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(data.data(), size));
+}
+
+CacheServeResult serveCachedFrames(
+    const DiskCache& cache,
+    const std::string& key,
+    int num_frames,
+    const RenderConfig& config
+) {
+    // Pin the entry so concurrent eviction cannot remove frames while we read them
+    std::string pinned = cache.pin(key);
+    if (pinned.empty()) {
+        LOG_DEBUG("[CACHE] Miss for key " << key);
+        return CacheServeResult::MISS;
+    }
+
+    // Verify the entry is complete before writing anything (stdout output cannot be undone)
+    for (int i = 0; i < num_frames; i++) {
+        std::error_code ec;
+        if (!fs::is_regular_file(cachedFramePath(pinned, i), ec)) {
+            LOG_CERR("[WARNING] Cache entry " << key << " is incomplete (missing frame " << i << "), re-rendering") << std::endl;
+            cache.release(pinned);
+            return CacheServeResult::MISS;
+        }
+    }
+
+    bool ok = true;
+    if (config.stream_mode) {
+        std::vector<char> data;
+        for (int i = 0; i < num_frames && ok; i++) {
+            if (!readFile(cachedFramePath(pinned, i), data)) {
+                LOG_CERR("[ERROR] Failed to read cached frame " << i) << std::endl;
+                ok = false;
+                break;
+            }
+            std::cout.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!std::cout.good()) {
+                LOG_CERR("[ERROR] Failed to write frame " << i << " to stdout") << std::endl;
+                ok = false;
+            }
+        }
+        std::cout.flush();
+    } else {
+        // Copy rather than hard-link: a later render into output_dir truncates files in place
+        for (int i = 0; i < num_frames && ok; i++) {
+            std::error_code ec;
+            fs::copy_file(cachedFramePath(pinned, i), cachedFramePath(config.output_dir, i),
+                          fs::copy_options::overwrite_existing, ec);
+            if (ec) {
+                LOG_CERR("[ERROR] Failed to copy cached frame " << i << " to " << config.output_dir << ": " << ec.message()) << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    cache.release(pinned);
+    if (!ok) {
+        // Partially copied files are overwritten by a re-render; a partial stream is not recoverable
+        return config.stream_mode ? CacheServeResult::FAILED : CacheServeResult::MISS;
+    }
+    return CacheServeResult::SERVED;
+}
+
+bool storeCachedFrames(
+    const DiskCache& cache,
+    const std::string& key,
+    int num_frames,
+    const std::string& frames_dir
+) {
+    std::string staging = cache.beginEntry(key);
+    if (staging.empty()) {
+        return false;
+    }
+    for (int i = 0; i < num_frames; i++) {
+        std::error_code ec;
+        fs::copy_file(cachedFramePath(frames_dir, i), cachedFramePath(staging, i), ec);
+        if (ec) {
+            LOG_CERR("[WARNING] Could not store frame " << i << " in render cache: " << ec.message()) << std::endl;
+            cache.abortEntry(staging);
+            return false;
+        }
+    }
+    return cache.commitEntry(key, staging);
+}
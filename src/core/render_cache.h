@@ -0,0 +1,54 @@
+#ifndef RENDER_CACHE_H
+#define RENDER_CACHE_H
+
+#include "renderer.h"
+#include "image_assets.h"
+#include "../utils/disk_cache.h"
+#include <string>
+#include <vector>
+
+// Render result cache: frames of a finished render stored under a key that hashes every input
+// affecting the output (processed JSON bytes, referenced image files, the fonts available to text
+// layers, size, fps, rendered frame times, output options such as the background color, encoder
+// settings, and lotio version)
+
+// Compute the cache key for a render
+// image_assets: the external images json_data references (collectImageAssets())
+std::string computeRenderCacheKey(
+    const SkData& json_data,
+    const std::vector<ImageAssetRef>& image_assets,
+    const std::string& asset_base_dir,
+    int width,
+    int height,
+    float fps,
+    const std::vector<float>& frame_times,
+    const std::string& output_options
+);
+
+// Result of serving a cached render
+enum class CacheServeResult {
+    SERVED,   // All frames written
+    MISS,     // No usable entry; nothing was written to stdout
+    FAILED    // Output failed after it started (stream mode cannot re-render on top of it)
+};
+
+// Serve a cached render: copy frames to config.output_dir, or write them to stdout in stream mode
+CacheServeResult serveCachedFrames(
+    const DiskCache& cache,
+    const std::string& key,
+    int num_frames,
+    const RenderConfig& config
+);
+
+// Store rendered frames from frames_dir (frame_%05d.png) as a new cache entry
+bool storeCachedFrames(
+    const DiskCache& cache,
+    const std::string& key,
+    int num_frames,
+    const std::string& frames_dir
+);
+
+// Frame file path inside a directory, matching writeFrameToFile() naming
+std::string cachedFramePath(const std::string& dir, int frame_idx);
+
+#endif // RENDER_CACHE_H
@@ -1,10 +1,17 @@
 #include "renderer.h"
 #include "frame_encoder.h"
+#include "render_cache.h"
+#include "sprite_sheet.h"
+#include "content_bounds.h"
+#include "image_cache.h"
+#include "pixel_convert.h"
 #include "../utils/logging.h"
+#include "../utils/profiler.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkData.h"
 #include <vector>
 #include <thread>
@@ -16,6 +23,9 @@
 #include <sstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <fstream>
+#include <nlohmann/json.hpp>
 
 // Frame buffer for streaming mode (ensures sequential output)
 struct BufferedFrame {
@@ -26,10 +36,91 @@ struct BufferedFrame {
     BufferedFrame() : frame_idx(-1), ready(false) {}
 };
 
+// Single-frame renders at or above this size are split into bands across threads (--at)
+static const int64_t kTiledFrameMinPixels = 1280 * 720;
+static const int kMaxFrameBands = 8;
+
+// Time of frame i on an output timeline of num_frames frames (last frame lands on duration)
+static float timelineFrameTime(int i, int num_frames, float duration) {
+    return (i < num_frames - 1) ? (float)i / (num_frames - 1) * duration : duration;
+}
+
+// Render one frame split into horizontal bands, one animation per band
+// Each band wraps its own rows of the shared pixel buffer, so bands never touch the same memory
+static sk_sp<SkImage> renderFrameTiled(
+    const std::vector<sk_sp<skottie::Animation>>& animations,
+    float t,
+    const SkImageInfo& info,
+    uint8_t* pixels,
+    size_t rowBytes,
+    float origin_x,
+    float origin_y,
+    SkColor clear_color
+) {
+    const int height = info.height();
+    const int bands = std::min(static_cast<int>(animations.size()), height);
+    std::atomic<bool> ok(true);
+
+    std::vector<std::thread> band_threads;
+    for (int b = 0; b < bands; b++) {
+        const int y0 = height * b / bands;
+        const int y1 = height * (b + 1) / bands;
+        band_threads.emplace_back([&, b, y0, y1]() {
+            auto band_surface = SkSurfaces::WrapPixels(info.makeWH(info.width(), y1 - y0),
+                                                       pixels + y0 * rowBytes, rowBytes, nullptr);
+            if (!band_surface) {
+                LOG_CERR("[ERROR] Failed to create surface for band " << b) << std::endl;
+                ok = false;
+                return;
+            }
+            auto* canvas = band_surface->getCanvas();
+            canvas->clear(clear_color);
+            canvas->translate(origin_x, origin_y - static_cast<float>(y0));
+            animations[b]->seekFrameTime(t);
+            animations[b]->render(canvas);
+        });
+    }
+    for (auto& band_thread : band_threads) {
+        band_thread.join();
+    }
+    if (!ok) {
+        return nullptr;
+    }
+
+    auto full_surface = SkSurfaces::WrapPixels(info, pixels, rowBytes, nullptr);
+    return full_surface ? full_surface->makeImageSnapshot() : nullptr;
+}
+
+// Report the auto-trim crop so callers can composite frames back onto the original canvas
+// Written to <output_dir>/trim.json (except in stream mode) and logged
+static void reportContentBounds(const SkIRect& rect, int canvas_width, int canvas_height, const RenderConfig& config) {
+    LOG_CERR("[INFO] Auto-trim: rendering " << rect.width() << "x" << rect.height() << " at offset ("
+             << rect.x() << ", " << rect.y() << ") of the " << canvas_width << "x" << canvas_height << " canvas") << std::endl;
+    if (config.stream_mode) {
+        return;
+    }
+
+    nlohmann::json trim;
+    trim["x"] = rect.x();
+    trim["y"] = rect.y();
+    trim["width"] = rect.width();
+    trim["height"] = rect.height();
+    trim["canvasWidth"] = canvas_width;
+    trim["canvasHeight"] = canvas_height;
+
+    std::string trim_path = config.output_dir + "/trim.json";
+    std::ofstream trim_file(trim_path);
+    if (!trim_file.is_open()) {
+        LOG_CERR("[WARNING] Could not write auto-trim offsets to " << trim_path) << std::endl;
+        return;
+    }
+    trim_file << trim.dump(4) << std::endl;
+}
+
 int renderFrames(
     sk_sp<skottie::Animation> animation,
     skottie::Animation::Builder& builder,
-    const std::string& json_data,
+    const SkData& json_data,
     const RenderConfig& config
 ) {
     // Get animation dimensions and duration
@@ -44,43 +135,110 @@ int renderFrames(
     LOG_DEBUG("Animation FPS: " << animation_fps);
     LOG_DEBUG("Output FPS: " << config.fps);
 
-    // Calculate number of frames to render
-    int num_frames = static_cast<int>(std::ceil(duration * config.fps));
+    // Calculate number of frames on the output timeline
+    int timeline_frames = static_cast<int>(std::ceil(duration * config.fps));
+
+    // Pre-compute frame times (avoid per-frame calculation)
+    // Full timeline, or only the selected frames (--at) in request order
+    std::vector<float> frame_times;
+    if (config.selected_frames.empty()) {
+        frame_times.resize(timeline_frames);
+        for (int i = 0; i < timeline_frames; i++) {
+            frame_times[i] = timelineFrameTime(i, timeline_frames, duration);
+        }
+    } else {
+        for (const auto& selection : config.selected_frames) {
+            if (selection.is_seconds) {
+                if (selection.value > duration) {
+                    LOG_CERR("[ERROR] Requested time " << selection.value << "s is past the end of the animation (" << duration << "s)") << std::endl;
+                    return 1;
+                }
+                frame_times.push_back(static_cast<float>(selection.value));
+            } else {
+                int frame = static_cast<int>(selection.value);
+                if (frame >= timeline_frames) {
+                    LOG_CERR("[ERROR] Requested frame " << frame << " is outside the timeline (0-" << (timeline_frames - 1) << " at " << config.fps << " fps)") << std::endl;
+                    return 1;
+                }
+                frame_times.push_back(timelineFrameTime(frame, timeline_frames, duration));
+            }
+        }
+    }
+    int num_frames = static_cast<int>(frame_times.size());
     LOG_DEBUG("Rendering " << num_frames << " frames...");
 
-    // Create a surface to render to with transparent background
-    // Use kUnpremul_SkAlphaType to preserve transparency better
-    LOG_DEBUG("Creating Skia surface: " << width << "x" << height << " with kUnpremul_SkAlphaType");
-    SkImageInfo info = SkImageInfo::MakeN32(width, height, kUnpremul_SkAlphaType);
-    
-    // CRITICAL: Allocate pixel buffer explicitly initialized to transparent
-    // This ensures the surface starts with transparent pixels, not black
-    size_t rowBytes = info.minRowBytes();
-    size_t totalBytes = info.computeByteSize(rowBytes);
+    const bool sprite_mode = config.sprite_columns > 0;
 
-    // Create RGBA conversion surface once (reuse for all frames)
-    SkImageInfo rgbaInfo = SkImageInfo::MakeN32(width, height, kUnpremul_SkAlphaType);
-    auto rgbaSurface = SkSurfaces::Raster(rgbaInfo);
-    if (!rgbaSurface) {
-        LOG_CERR("[ERROR] Failed to create RGBA conversion surface") << std::endl;
-        return 1;
+    // Consult the render cache before creating per-thread animations
+    // (sprite sheets and auto-trim bypass it: cache entries hold only frame files)
+    std::unique_ptr<DiskCache> cache;
+    std::string cache_key;
+    std::string cache_staging_dir;  // Stream mode: workers also write frames here
+    std::atomic<bool> cache_write_failed(false);
+    if (!config.cache_dir.empty() && !sprite_mode && !config.auto_trim) {
+        cache = std::make_unique<DiskCache>(config.cache_dir, config.cache_max_bytes);
+        if (cache->valid()) {
+            char output_options[32];
+            snprintf(output_options, sizeof(output_options), "background=%08x", config.background);
+            std::vector<ImageAssetRef> collected_assets;
+            if (!config.image_assets) {
+                collected_assets = collectImageAssets(json_data);
+            }
+            cache_key = computeRenderCacheKey(json_data, config.image_assets ? *config.image_assets : collected_assets,
+                                              config.asset_base_dir, width, height, config.fps,
+                                              frame_times, output_options);
+            LOG_DEBUG("[CACHE] Render cache key: " << cache_key);
+            CacheServeResult served = serveCachedFrames(*cache, cache_key, num_frames, config);
+            if (served == CacheServeResult::SERVED) {
+                if (config.stream_mode) {
+                    LOG_CERR("[INFO] Streamed " << num_frames << " cached frames to stdout") << std::endl;
+                } else {
+                    LOG_COUT("[INFO] Served " << num_frames << " cached frames to " << config.output_dir) << std::endl;
+                }
+                return 0;
+            }
+            if (served == CacheServeResult::FAILED) {
+                return 1;
+            }
+            if (config.stream_mode) {
+                cache_staging_dir = cache->beginEntry(cache_key);
+            }
+        } else {
+            cache.reset();
+        }
     }
-    LOG_DEBUG("RGBA conversion surface created (will be reused for all frames)");
 
     // Determine number of threads for parallel rendering
-    int num_threads = std::max(1, (int)std::thread::hardware_concurrency());
-    LOG_DEBUG("Using " << num_threads << " threads for parallel rendering");
+    // Never more threads (and per-thread animations) than frames; a single large frame is
+    // instead split into horizontal bands rendered in parallel
+    int hardware_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    bool tiled = (!sprite_mode && num_frames == 1 && hardware_threads > 1 &&
+                  static_cast<int64_t>(width) * height >= kTiledFrameMinPixels);
+    int num_threads = tiled ? std::min(hardware_threads, std::min(kMaxFrameBands, height))
+                            : std::min(hardware_threads, std::max(1, num_frames));
+    if (tiled) {
+        LOG_DEBUG("Using " << num_threads << " bands for intra-frame parallel rendering");
+    } else {
+        LOG_DEBUG("Using " << num_threads << " threads for parallel rendering");
+    }
 
     // Create per-thread animations and surfaces
     std::vector<sk_sp<skottie::Animation>> thread_animations;
     std::vector<sk_sp<SkSurface>> thread_surfaces;
     std::vector<sk_sp<SkSurface>> thread_rgba_surfaces;
     std::vector<std::vector<uint8_t>> thread_pixel_buffers;
+    std::vector<std::vector<uint8_t>> thread_convert_buffers;  // Unpremultiply output, grown on first use
 
+    ScopedPhase animations_phase("per-thread animations");
     for (int t = 0; t < num_threads; t++) {
         // Create animation for each thread (thread-safe: each thread has its own)
+        // Thread 0 reuses the already parsed animation
         LOG_DEBUG("Creating animation for thread " << t << "...");
-        auto thread_animation = builder.make(json_data.c_str(), json_data.length());
+        sk_sp<skottie::Animation> thread_animation = animation;
+        if (t > 0) {
+            ScopedPhase make_phase(("builder.make (thread " + std::to_string(t) + ")").c_str());
+            thread_animation = builder.make(static_cast<const char*>(json_data.data()), json_data.size());
+        }
         if (!thread_animation) {
             LOG_CERR("[ERROR] Failed to create animation for thread " << t) << std::endl;
             LOG_CERR("[ERROR] This may indicate JSON parsing issues or resource loading failures") << std::endl;
@@ -89,6 +247,58 @@ int renderFrames(
         }
         thread_animations.push_back(thread_animation);
         LOG_DEBUG("Animation created successfully for thread " << t);
+    }
+    animations_phase.end();
+
+    // Auto-trim: find the animated content bounds in a low-resolution pre-pass, then render,
+    // convert and encode only that rectangle
+    SkIRect content_rect = SkIRect::MakeWH(width, height);
+    if (config.auto_trim) {
+        SkIRect bounds = computeContentBounds(thread_animations, frame_times, width, height);
+        if (bounds.isEmpty()) {
+            LOG_CERR("[WARNING] Auto-trim: animation draws nothing, keeping the full " << width << "x" << height << " canvas") << std::endl;
+        } else {
+            content_rect = bounds;
+        }
+        reportContentBounds(content_rect, width, height, config);
+        width = content_rect.width();
+        height = content_rect.height();
+    }
+    const float origin_x = static_cast<float>(-content_rect.x());
+    const float origin_y = static_cast<float>(-content_rect.y());
+
+    // Create a surface to render to with transparent background
+    // Use kUnpremul_SkAlphaType to preserve transparency better
+    // With an opaque background (--background) the surface is opaque: frames are flattened onto
+    // the color and PNG-encoded as 24-bit RGB, with no unpremultiply
+    const bool opaque_background = (SkColorGetA(config.background) == 0xFF);
+    const SkAlphaType surface_alpha_type = opaque_background ? kOpaque_SkAlphaType : kUnpremul_SkAlphaType;
+    const SkColor clear_color = opaque_background ? config.background : SK_ColorTRANSPARENT;
+    LOG_DEBUG("Creating Skia surface: " << width << "x" << height << " with "
+              << (opaque_background ? "kOpaque_SkAlphaType" : "kUnpremul_SkAlphaType"));
+    SkImageInfo info = SkImageInfo::MakeN32(width, height, surface_alpha_type);
+    
+    // CRITICAL: Allocate pixel buffer explicitly initialized to transparent
+    // This ensures the surface starts with transparent pixels, not black
+    size_t rowBytes = info.minRowBytes();
+    size_t totalBytes = info.computeByteSize(rowBytes);
+
+    // Create RGBA conversion surface once (reuse for all frames)
+    ScopedPhase surfaces_phase("surface allocation");
+    SkImageInfo rgbaInfo = SkImageInfo::MakeN32(width, height, surface_alpha_type);
+    auto rgbaSurface = SkSurfaces::Raster(rgbaInfo);
+    if (!rgbaSurface) {
+        LOG_CERR("[ERROR] Failed to create RGBA conversion surface") << std::endl;
+        return 1;
+    }
+    LOG_DEBUG("RGBA conversion surface created (will be reused for all frames)");
+
+    for (int t = 0; t < num_threads; t++) {
+        // Bands share thread 0's pixel buffer and sprite tiles wrap the atlas buffer;
+        // neither needs per-thread surfaces
+        if ((tiled && t > 0) || sprite_mode) {
+            continue;
+        }
         
         // Create surface for each thread
         std::vector<uint8_t> thread_pixels(totalBytes, 0);
@@ -109,14 +319,17 @@ int renderFrames(
             return 1;
         }
         thread_rgba_surfaces.push_back(thread_rgba_surface);
+        thread_convert_buffers.emplace_back();
         LOG_DEBUG("Thread " << t << " setup complete - ready for rendering");
     }
     LOG_DEBUG("All " << num_threads << " threads initialized successfully");
+    surfaces_phase.end();
 
-    // Pre-compute frame times (avoid per-frame calculation)
-    std::vector<float> frame_times(num_frames);
-    for (int i = 0; i < num_frames; i++) {
-        frame_times[i] = (i < num_frames - 1) ? (float)i / (num_frames - 1) * duration : duration;
+    if (sprite_mode) {
+        SpriteSheetLayout layout = computeSpriteSheetLayout(num_frames, width, height,
+                                                            config.sprite_columns, config.sprite_scale);
+        return renderSpriteSheet(thread_animations, frame_times, layout, origin_x, origin_y,
+                                 config.fps, config.output_dir, config.image_cache);
     }
 
     // Pre-distribute frames to threads (round-robin for better load balancing)
@@ -150,6 +363,9 @@ int renderFrames(
         auto& surface = thread_surfaces[thread_id];
         auto& rgba_surface = thread_rgba_surfaces[thread_id];
         auto* canvas = surface->getCanvas();
+
+        // Shift the content rectangle (auto-trim) to the surface origin; clear() ignores the matrix
+        canvas->translate(origin_x, origin_y);
         
         // Thread-local progress counter to reduce atomic contention
         thread_local int local_completed = 0;
@@ -160,10 +376,13 @@ int renderFrames(
             // Use pre-computed frame time
             float t = frame_times[frame_idx];
             
-            // Clear canvas with transparent background
-            canvas->clear(SK_ColorTRANSPARENT);
+            // Clear canvas with transparent (or opaque --background) color
+            canvas->clear(clear_color);
 
             // Seek to the desired frame time
+            if (config.image_cache) {
+                config.image_cache->setPlayhead(t);
+            }
             animation->seekFrameTime(t);
             
             // Render the animation frame (this will render all layers including images)
@@ -204,16 +423,36 @@ int renderFrames(
             
             // Check if conversion is needed (only convert if necessary)
             bool needs_conversion = (imgInfo.colorType() != kN32_SkColorType || 
-                                     imgInfo.alphaType() != kUnpremul_SkAlphaType);
+                                     imgInfo.alphaType() != surface_alpha_type);
             
             if (needs_conversion) {
                 if (frame_idx == 0 && thread_id == 0) {
-                    LOG_DEBUG("Image conversion needed: colorType=" << imgInfo.colorType() << " (expected " << kN32_SkColorType << "), alphaType=" << imgInfo.alphaType() << " (expected " << kUnpremul_SkAlphaType << ")");
+                    LOG_DEBUG("Image conversion needed: colorType=" << imgInfo.colorType() << " (expected " << kN32_SkColorType << "), alphaType=" << imgInfo.alphaType() << " (expected " << surface_alpha_type << ")");
+                }
+                // Premultiplied 8888 -> unpremultiplied N32: run the dedicated kernel into this
+                // thread's pooled buffer instead of a full Skia draw through the RGBA surface
+                SkPixmap src_pixmap;
+                bool is_8888 = imgInfo.colorType() == kRGBA_8888_SkColorType ||
+                               imgInfo.colorType() == kBGRA_8888_SkColorType;
+                if (is_8888 && imgInfo.alphaType() == kPremul_SkAlphaType &&
+                    surface_alpha_type == kUnpremul_SkAlphaType &&
+                    image->peekPixels(&src_pixmap)) {
+                    auto& convert_buffer = thread_convert_buffers[thread_id];
+                    convert_buffer.resize(totalBytes);
+                    unpremultiplyPixels(static_cast<const uint8_t*>(src_pixmap.addr()), src_pixmap.rowBytes(),
+                                        convert_buffer.data(), rowBytes, width, height,
+                                        imgInfo.colorType() != kN32_SkColorType);
+                    image = SkImages::RasterFromPixmap(SkPixmap(info, convert_buffer.data(), rowBytes),
+                                                       nullptr, nullptr);
+                    if (frame_idx == 0 && thread_id == 0) {
+                        LOG_DEBUG("Unpremultiplied frame with " << unpremultiplyKernelName() << " kernel");
+                    }
+                } else {
+                    // Convert to RGBA_8888 with kUnpremul_SkAlphaType (or opaque)
+                    rgba_surface->getCanvas()->clear(clear_color);
+                    rgba_surface->getCanvas()->drawImage(image, 0, 0, SkSamplingOptions());
+                    image = rgba_surface->makeImageSnapshot();
                 }
-                // Convert to RGBA_8888 with kUnpremul_SkAlphaType
-                rgba_surface->getCanvas()->clear(SK_ColorTRANSPARENT);
-                rgba_surface->getCanvas()->drawImage(image, 0, 0, SkSamplingOptions());
-                image = rgba_surface->makeImageSnapshot();
                 if (!image) {
                     LOG_CERR("[ERROR] Failed to convert image for frame " << frame_idx) << std::endl;
                     LOG_CERR("[ERROR] Image conversion failed - this may indicate a rendering surface issue") << std::endl;
@@ -247,6 +486,12 @@ int renderFrames(
                 LOG_DEBUG("Frame " << frame_idx << " complete: rendered -> snapped -> encoded");
             }
 
+            // Keep a copy of streamed frames for the render cache
+            if (!cache_staging_dir.empty() &&
+                writeFrameToFile(encoded, frame_idx, cache_staging_dir + "/frame_") > 0) {
+                cache_write_failed = true;
+            }
+
             // Write files or buffer for streaming
             if (config.stream_mode) {
                 // Buffer frame for sequential output
@@ -290,7 +535,7 @@ int renderFrames(
 
     // Sequential writer thread for streaming mode
     std::thread writer_thread;
-    if (config.stream_mode) {
+    if (config.stream_mode && !tiled) {
         writer_thread = std::thread([&]() {
             // Streaming mode outputs PNG (ffmpeg image2pipe expects PNG)
             
@@ -340,15 +585,45 @@ int renderFrames(
         });
     }
 
-    // Launch worker threads
-    std::vector<std::thread> workers;
-    for (int t = 0; t < num_threads; t++) {
-        workers.emplace_back(render_frame_worker, t);
-    }
+    if (tiled) {
+        // Single frame: render bands in parallel, then encode and write it directly
+        if (config.image_cache) {
+            config.image_cache->setPlayhead(frame_times[0]);
+        }
+        sk_sp<SkImage> image = renderFrameTiled(thread_animations, frame_times[0], info,
+                                                thread_pixel_buffers[0].data(), rowBytes,
+                                                origin_x, origin_y, clear_color);
+        EncodedFrame encoded = image ? encodeFrame(image) : EncodedFrame();
+        if (!encoded.has_png) {
+            LOG_CERR("[ERROR] Failed to render frame 0") << std::endl;
+            failed_frames++;
+        } else {
+            if (!cache_staging_dir.empty() &&
+                writeFrameToFile(encoded, 0, cache_staging_dir + "/frame_") > 0) {
+                cache_write_failed = true;
+            }
+            if (config.stream_mode) {
+                std::cout.write(reinterpret_cast<const char*>(encoded.png_data->data()), encoded.png_data->size());
+                std::cout.flush();
+                if (!std::cout.good()) {
+                    LOG_CERR("[ERROR] Failed to write frame 0 to stdout") << std::endl;
+                    failed_frames++;
+                }
+            } else if (writeFrameToFile(encoded, 0, filename_base) > 0) {
+                failed_frames++;
+            }
+        }
+    } else {
+        // Launch worker threads
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back(render_frame_worker, t);
+        }
 
-    // Wait for all threads to complete
-    for (auto& worker : workers) {
-        worker.join();
+        // Wait for all threads to complete
+        for (auto& worker : workers) {
+            worker.join();
+        }
     }
     
     // Wait for writer thread to complete
@@ -356,6 +631,21 @@ int renderFrames(
         writer_thread.join();
     }
 
+    // Publish the result to the render cache (only complete renders are cached)
+    if (cache) {
+        if (failed_frames > 0 || cache_write_failed) {
+            if (!cache_staging_dir.empty()) {
+                cache->abortEntry(cache_staging_dir);
+            }
+        } else if (config.stream_mode) {
+            if (!cache_staging_dir.empty()) {
+                cache->commitEntry(cache_key, cache_staging_dir);
+            }
+        } else {
+            storeCachedFrames(*cache, cache_key, num_frames, config.output_dir);
+        }
+    }
+
     // Check for failures
     if (failed_frames > 0) {
         LOG_CERR("[WARNING] " << failed_frames << " frames failed to render") << std::endl;
@@ -375,3 +665,12 @@ int renderFrames(
     return 0;
 }
 
+int renderFrames(
+    sk_sp<skottie::Animation> animation,
+    skottie::Animation::Builder& builder,
+    const std::string& json_data,
+    const RenderConfig& config
+) {
+    sk_sp<SkData> data = SkData::MakeWithoutCopy(json_data.data(), json_data.size());
+    return renderFrames(std::move(animation), builder, *data, config);
+}
@@ -3,18 +3,53 @@
 
 #include <skia/modules/skottie/include/Skottie.h>
 #include <skia/core/SkSurface.h>
+#include <skia/core/SkData.h>
 #include <string>
 #include <atomic>
+#include <cstdint>
+#include <vector>
+
+class ImageAssetCache;
+struct ImageAssetRef;
+
+// A requested frame for selected-frames mode (--at)
+struct FrameSelection {
+    bool is_seconds = false;  // true: time in seconds; false: frame index on the output-fps timeline
+    double value = 0.0;
+};
 
 // Render configuration
 struct RenderConfig {
     bool stream_mode = false;
     std::string output_dir;
     float fps = 30.0f;
+    std::string cache_dir;          // Render result cache directory (empty = caching disabled)
+    uint64_t cache_max_bytes = 0;   // Render cache size limit in bytes (0 = unbounded)
+    std::string asset_base_dir;     // Base directory of image assets (hashed into the cache key)
+    std::vector<FrameSelection> selected_frames;  // Render only these frames, in order (empty = full timeline)
+    int sprite_columns = 0;         // Sprite sheet output with this many tiles per row (0 = frame files)
+    float sprite_scale = 1.0f;      // Sprite sheet tile size relative to the animation size
+    bool auto_trim = false;         // Crop output to the union of animated content bounds
+    SkColor background = SK_ColorTRANSPARENT;  // Opaque color flattens frames to RGB (transparent = keep alpha)
+    ImageAssetCache* image_cache = nullptr;  // Lazy image cache to report the playhead to (null = none)
+    const std::vector<ImageAssetRef>* image_assets = nullptr;  // External images of the JSON (null = collect for the cache key)
 };
 
 // Render all frames of the animation
+// With config.selected_frames, only those frames are rendered and numbered in request order
+// With config.sprite_columns, frames are packed into one sprite sheet PNG plus a JSON index
+// With config.auto_trim, frames are cropped to the animated content (offset in <output_dir>/trim.json)
+// When config.cache_dir is set, a cached result for identical inputs is served instead of rendering
 // Returns 0 on success, 1 on failure
+// json_data: the JSON the animation was built from (re-parsed for per-thread animations)
+int renderFrames(
+    sk_sp<skottie::Animation> animation,
+    skottie::Animation::Builder& builder,
+    const SkData& json_data,
+    const RenderConfig& config
+);
+
+// Same as above for JSON held in a string (wrapped without copying)
 int renderFrames(
     sk_sp<skottie::Animation> animation,
     skottie::Animation::Builder& builder,
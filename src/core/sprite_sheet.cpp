@@ -0,0 +1,174 @@
+#include "sprite_sheet.h"
+#include "frame_encoder.h"
+#include "image_cache.h"
+#include "../utils/logging.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkImage.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+// Larger atlases cannot be uploaded as a single texture by most GPUs / WebGL implementations
+static const int kMaxPortableAtlasSize = 16384;
+
+SpriteSheetLayout computeSpriteSheetLayout(int num_frames, int width, int height, int columns, float scale) {
+    SpriteSheetLayout layout;
+    layout.scale = scale;
+    layout.columns = std::max(1, std::min(columns, num_frames));
+    layout.rows = std::max(1, (num_frames + layout.columns - 1) / layout.columns);
+    layout.tile_width = std::max(1, static_cast<int>(std::ceil(width * scale)));
+    layout.tile_height = std::max(1, static_cast<int>(std::ceil(height * scale)));
+    return layout;
+}
+
+// Write the frame index clients use to locate tiles in the atlas
+static bool writeSpriteSheetIndex(
+    const std::string& path,
+    const SpriteSheetLayout& layout,
+    const std::vector<float>& frame_times,
+    float fps
+) {
+    nlohmann::json index;
+    index["image"] = "spritesheet.png";
+    index["width"] = layout.atlasWidth();
+    index["height"] = layout.atlasHeight();
+    index["frameWidth"] = layout.tile_width;
+    index["frameHeight"] = layout.tile_height;
+    index["columns"] = layout.columns;
+    index["rows"] = layout.rows;
+    index["scale"] = layout.scale;
+    index["fps"] = fps;
+    index["frameCount"] = frame_times.size();
+
+    nlohmann::json frames = nlohmann::json::array();
+    for (size_t i = 0; i < frame_times.size(); i++) {
+        frames.push_back({
+            {"x", layout.tileX(static_cast<int>(i))},
+            {"y", layout.tileY(static_cast<int>(i))},
+            {"w", layout.tile_width},
+            {"h", layout.tile_height},
+            {"time", frame_times[i]}
+        });
+    }
+    index["frames"] = std::move(frames);
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << index.dump(4) << std::endl;
+    return file.good();
+}
+
+int renderSpriteSheet(
+    const std::vector<sk_sp<skottie::Animation>>& animations,
+    const std::vector<float>& frame_times,
+    const SpriteSheetLayout& layout,
+    float origin_x,
+    float origin_y,
+    float fps,
+    const std::string& output_dir,
+    ImageAssetCache* image_cache
+) {
+    const int num_frames = static_cast<int>(frame_times.size());
+    const int num_threads = static_cast<int>(animations.size());
+    const int atlas_width = layout.atlasWidth();
+    const int atlas_height = layout.atlasHeight();
+
+    LOG_DEBUG("Sprite sheet: " << num_frames << " frames, " << layout.columns << "x" << layout.rows
+              << " tiles of " << layout.tile_width << "x" << layout.tile_height
+              << " (atlas " << atlas_width << "x" << atlas_height << ")");
+    if (atlas_width > kMaxPortableAtlasSize || atlas_height > kMaxPortableAtlasSize) {
+        LOG_CERR("[WARNING] Sprite sheet is " << atlas_width << "x" << atlas_height
+                 << ", larger than " << kMaxPortableAtlasSize << " px - many GPUs cannot load it as one texture") << std::endl;
+        LOG_CERR("[WARNING] Use --sprite-scale or fewer frames (--at) to reduce the atlas size") << std::endl;
+    }
+
+    // One atlas buffer, initialized to transparent; every tile is a disjoint window into it
+    SkImageInfo atlas_info = SkImageInfo::MakeN32(atlas_width, atlas_height, kUnpremul_SkAlphaType);
+    size_t atlas_row_bytes = atlas_info.minRowBytes();
+    std::vector<uint8_t> atlas_pixels;
+    try {
+        atlas_pixels.assign(atlas_info.computeByteSize(atlas_row_bytes), 0);
+    } catch (const std::bad_alloc&) {
+        LOG_CERR("[ERROR] Not enough memory for a " << atlas_width << "x" << atlas_height << " sprite sheet") << std::endl;
+        return 1;
+    }
+    SkImageInfo tile_info = atlas_info.makeWH(layout.tile_width, layout.tile_height);
+
+    std::atomic<int> failed_frames(0);
+    auto render_tiles_worker = [&](int thread_id) {
+        auto& animation = animations[thread_id];
+        for (int frame_idx = thread_id; frame_idx < num_frames; frame_idx += num_threads) {
+            uint8_t* tile_pixels = atlas_pixels.data() +
+                                   static_cast<size_t>(layout.tileY(frame_idx)) * atlas_row_bytes +
+                                   static_cast<size_t>(layout.tileX(frame_idx)) * atlas_info.bytesPerPixel();
+            auto tile_surface = SkSurfaces::WrapPixels(tile_info, tile_pixels, atlas_row_bytes, nullptr);
+            if (!tile_surface) {
+                LOG_CERR("[ERROR] Failed to create tile surface for frame " << frame_idx) << std::endl;
+                failed_frames++;
+                continue;
+            }
+
+            // Render at tile resolution directly (no full-size render + downsample)
+            auto* canvas = tile_surface->getCanvas();
+            canvas->scale(layout.scale, layout.scale);
+            canvas->translate(origin_x, origin_y);
+            if (image_cache) {
+                image_cache->setPlayhead(frame_times[frame_idx]);
+            }
+            animation->seekFrameTime(frame_times[frame_idx]);
+            animation->render(canvas);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < num_threads; t++) {
+        workers.emplace_back(render_tiles_worker, t);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed_frames > 0) {
+        LOG_CERR("[ERROR] " << failed_frames << " sprite sheet frames failed to render") << std::endl;
+        return 1;
+    }
+
+    // Encode the whole atlas once
+    auto atlas_surface = SkSurfaces::WrapPixels(atlas_info, atlas_pixels.data(), atlas_row_bytes, nullptr);
+    sk_sp<SkImage> atlas_image = atlas_surface ? atlas_surface->makeImageSnapshot() : nullptr;
+    if (!atlas_image) {
+        LOG_CERR("[ERROR] Failed to create sprite sheet image") << std::endl;
+        return 1;
+    }
+    EncodedFrame encoded = encodeFrame(atlas_image);
+    if (!encoded.has_png) {
+        LOG_CERR("[ERROR] Failed to encode sprite sheet PNG") << std::endl;
+        return 1;
+    }
+
+    std::string png_path = output_dir + "/spritesheet.png";
+    std::ofstream png_file(png_path, std::ios::binary);
+    if (!png_file.is_open() ||
+        !png_file.write(reinterpret_cast<const char*>(encoded.png_data->data()), encoded.png_data->size())) {
+        LOG_CERR("[ERROR] Could not write sprite sheet: " << png_path) << std::endl;
+        LOG_CERR("[ERROR] Check file permissions and disk space") << std::endl;
+        return 1;
+    }
+    png_file.close();
+
+    std::string index_path = output_dir + "/spritesheet.json";
+    if (!writeSpriteSheetIndex(index_path, layout, frame_times, fps)) {
+        LOG_CERR("[ERROR] Could not write sprite sheet index: " << index_path) << std::endl;
+        return 1;
+    }
+
+    LOG_COUT("[INFO] Successfully rendered " << num_frames << " frames to sprite sheet " << png_path
+             << " (" << atlas_width << "x" << atlas_height << ", " << encoded.png_data->size() << " bytes)") << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef SPRITE_SHEET_H
+#define SPRITE_SHEET_H
+
+#include <skia/modules/skottie/include/Skottie.h>
+#include <string>
+#include <vector>
+
+class ImageAssetCache;
+
+// Sprite sheet (atlas) layout: frames packed row-major into a grid of equal tiles
+struct SpriteSheetLayout {
+    int columns = 0;
+    int rows = 0;
+    int tile_width = 0;
+    int tile_height = 0;
+    float scale = 1.0f;   // Tile size relative to the animation size
+
+    int atlasWidth() const { return columns * tile_width; }
+    int atlasHeight() const { return rows * tile_height; }
+    int tileX(int frame_idx) const { return (frame_idx % columns) * tile_width; }
+    int tileY(int frame_idx) const { return (frame_idx / columns) * tile_height; }
+};
+
+// Compute the layout for num_frames frames of width x height pixels
+// columns: tiles per row (clamped to num_frames); scale: frame downscale factor (0.0-1.0]
+SpriteSheetLayout computeSpriteSheetLayout(int num_frames, int width, int height, int columns, float scale);
+
+// Render frames straight into the tiles of one atlas buffer, encode it once as PNG and
+// write <output_dir>/spritesheet.png plus the frame index <output_dir>/spritesheet.json
+// Each animation is used by one thread; frames are distributed round-robin
+// origin_x/origin_y: translation applied before rendering (negated auto-trim offset)
+// image_cache: lazy image cache told the time of each frame (may be null)
+// Returns 0 on success, 1 on failure
+int renderSpriteSheet(
+    const std::vector<sk_sp<skottie::Animation>>& animations,
+    const std::vector<float>& frame_times,
+    const SpriteSheetLayout& layout,
+    float origin_x,
+    float origin_y,
+    float fps,
+    const std::string& output_dir,
+    ImageAssetCache* image_cache = nullptr
+);
+
+#endif // SPRITE_SHEET_H
@@ -4,17 +4,125 @@
 
 #include "utils/logging.h"
 #include "utils/crash_handler.h"
+#include "utils/profiler.h"
 #include "core/argument_parser.h"
 #include "core/animation_setup.h"
 #include "core/renderer.h"
+#include "text/font_service.h"
+#include "text/text_fit_cache.h"
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+// Resolve output fps: animation fps if not explicitly provided, with fallback to 30
+static float resolveFps(const Arguments& args, const sk_sp<skottie::Animation>& animation) {
+    if (!args.fps_explicitly_set) {
+        float animation_fps = animation->fps();
+        return (animation_fps > 0.0f) ? animation_fps : 30.0f;
+    }
+    return args.fps;
+}
+
+// Render options shared by single and variant renders
+static void applyRenderOptions(const Arguments& args, const AnimationSetupResult& setup_result, RenderConfig& render_config) {
+    render_config.fps = resolveFps(args, setup_result.animation);
+    render_config.selected_frames = args.at_frames;
+    render_config.sprite_columns = args.sprite_columns;
+    render_config.sprite_scale = args.sprite_scale;
+    render_config.auto_trim = args.auto_trim;
+    render_config.background = args.background_color;
+    render_config.cache_dir = args.cache_dir;
+    render_config.cache_max_bytes = args.cache_max_mb * 1024 * 1024;
+    render_config.asset_base_dir = setup_result.base_dir;
+    render_config.image_cache = setup_result.image_cache.get();
+    render_config.image_assets = &setup_result.image_assets;
+}
+
+// Render every layer-overrides file of the variants list against one loaded template
+// Each variant is written to <output_dir>/<overrides file stem>/
+static int renderVariants(const Arguments& args) {
+    LOG_DEBUG("Loading animation template for " << args.variant_overrides.size() << " variants...");
+    AnimationTemplate tmpl;
+    ScopedPhase template_phase("load template");
+    bool template_loaded = loadAnimationTemplate(args.input_file, tmpl);
+    template_phase.end();
+    if (!template_loaded) {
+        LOG_CERR("[ERROR] Animation template setup failed - check input file") << std::endl;
+        return 1;
+    }
+
+    std::set<std::string> used_names;
+    int failed = 0;
+    for (size_t v = 0; v < args.variant_overrides.size(); v++) {
+        const std::string& overrides_file = args.variant_overrides[v];
+
+        // Output subdirectory named after the overrides file; suffix duplicates with the list index
+        std::string name = std::filesystem::path(overrides_file).stem().string();
+        if (name.empty() || !used_names.insert(name).second) {
+            name += "_" + std::to_string(v);
+            used_names.insert(name);
+        }
+        std::filesystem::path variant_dir = std::filesystem::path(args.output_dir) / name;
+        std::error_code ec;
+        std::filesystem::create_directories(variant_dir, ec);
+        if (ec) {
+            LOG_CERR("[ERROR] Could not create variant output directory: " << variant_dir.string() << " (" << ec.message() << ")") << std::endl;
+            failed++;
+            continue;
+        }
+
+        LOG_DEBUG("Rendering variant " << (v + 1) << "/" << args.variant_overrides.size() << ": " << overrides_file);
+        ScopedPhase setup_phase("instantiate variant");
+        AnimationSetupResult setup_result = instantiateAnimationTemplate(
+            tmpl,
+            overrides_file,
+            args.text_padding,
+            args.text_measurement_mode,
+            args.image_cache_mb * 1024 * 1024
+        );
+        setup_phase.end();
+        if (!setup_result.success()) {
+            LOG_CERR("[ERROR] Animation setup failed for variant: " << overrides_file) << std::endl;
+            failed++;
+            continue;
+        }
+
+        RenderConfig render_config;
+        render_config.stream_mode = false;
+        render_config.output_dir = variant_dir.string();
+        applyRenderOptions(args, setup_result, render_config);
+
+        ScopedPhase render_phase("render variant");
+        if (renderFrames(setup_result.animation, setup_result.builder,
+                         *setup_result.json_data, render_config) != 0) {
+            failed++;
+        }
+    }
+    printStartupProfile();
+
+    if (failed > 0) {
+        LOG_CERR("[ERROR] " << failed << " of " << args.variant_overrides.size() << " variants failed") << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     installCrashHandlers();
     installExceptionHandlers();
 
+    // Profiling is enabled before parsing so argument validation is measured too
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--profile-startup") == 0) {
+            g_profile_startup = true;
+        }
+    }
+
     // Parse command-line arguments
     Arguments args;
+    ScopedPhase parse_phase("parse arguments");
     int parse_result = parseArguments(argc, argv, args);
+    parse_phase.end();
     if (parse_result == 2) {
         // Help was shown - exit successfully
         return 0;
@@ -32,14 +140,37 @@ int main(int argc, char* argv[]) {
     g_stream_mode = args.stream_mode;
     g_debug_mode = args.debug_mode;
 
+    // Fonts from a directory replace fontconfig for the whole process
+    if (!args.font_dir.empty()) {
+        ScopedPhase font_phase("font manager (--font-dir)");
+        // Read-only font directories keep their index next to the cache (or in the temp directory)
+        std::string font_index_dir = args.cache_dir.empty() ? "" : (std::filesystem::path(args.cache_dir) / "_fontindex").string();
+        if (!useFontDirectory(args.font_dir, font_index_dir)) {
+            LOG_CERR("[ERROR] Could not load fonts from --font-dir: " << args.font_dir) << std::endl;
+            return 1;
+        }
+    }
+
+    // Text fits are memoized next to the rendered frames (an unusable directory is reported and skipped)
+    if (!args.cache_dir.empty()) {
+        useTextFitCache(args.cache_dir);
+    }
+
+    if (!args.variant_overrides.empty()) {
+        return renderVariants(args);
+    }
+
     // Setup and create animation
     LOG_DEBUG("Starting animation setup and image loading...");
+    ScopedPhase setup_phase("animation setup");
     AnimationSetupResult setup_result = setupAndCreateAnimation(
         args.input_file, 
         args.layer_overrides_file,
         args.text_padding,
-        args.text_measurement_mode
+        args.text_measurement_mode,
+        args.image_cache_mb * 1024 * 1024
     );
+    setup_phase.end();
     if (!setup_result.success()) {
         LOG_CERR("[ERROR] Animation setup failed - check input file and image paths") << std::endl;
         return 1;
@@ -50,20 +181,17 @@ int main(int argc, char* argv[]) {
     RenderConfig render_config;
     render_config.stream_mode = args.stream_mode;
     render_config.output_dir = args.output_dir;
-    
-    // Use animation fps if not explicitly provided, with fallback to 30
-    if (!args.fps_explicitly_set) {
-        float animation_fps = setup_result.animation->fps();
-        render_config.fps = (animation_fps > 0.0f) ? animation_fps : 30.0f;
-    } else {
-        render_config.fps = args.fps;
-    }
+    applyRenderOptions(args, setup_result, render_config);
 
     // Render all frames
-    return renderFrames(
+    ScopedPhase render_phase("render");
+    int render_result = renderFrames(
         setup_result.animation,
         setup_result.builder,
-        setup_result.processed_json,
+        *setup_result.json_data,
         render_config
     );
+    render_phase.end();
+    printStartupProfile();
+    return render_result;
 }
@@ -0,0 +1,453 @@
+#include "directory_font_mgr.h"
+#include "../utils/logging.h"
+#include "../utils/sha256.h"
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// On-disk index layout: IndexHeader, face_count IndexFace records, then a pool of
+// NUL-terminated strings referenced by offset. Native byte order; the index is a local cache.
+static constexpr char kIndexMagic[8] = {'L', 'O', 'T', 'I', 'O', 'F', 'N', 'T'};
+static constexpr uint32_t kIndexVersion = 1;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t face_count;
+    char signature[64];     // SHA-256 (hex) of the font file listing the index was built from
+    uint32_t strings_size;
+    uint32_t reserved;
+};
+
+struct IndexFace {
+    uint32_t path;          // Offsets into the string pool; path is relative to the font directory
+    uint32_t family;
+    uint32_t postscript_name;
+    int32_t ttc_index;
+    int32_t weight;
+    int32_t width;
+    int32_t slant;
+};
+
+static bool isFontFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".ttf" || ext == ".otf" || ext == ".ttc" || ext == ".otc";
+}
+
+static bool equalsIgnoreCase(const std::string& a, const char* b) {
+    size_t length = std::strlen(b);
+    if (a.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Font files under the directory (relative paths, sorted) and a signature of their sizes and mtimes
+static std::vector<std::string> listFontFiles(const fs::path& directory, std::string& signature) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && isFontFile(it->path())) {
+            files.push_back(it->path().lexically_relative(directory).generic_string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    Sha256 hasher;
+    for (const auto& file : files) {
+        fs::path fullPath = directory / file;
+        std::error_code statEc;
+        uintmax_t size = fs::file_size(fullPath, statEc);
+        auto mtime = fs::last_write_time(fullPath, statEc).time_since_epoch().count();
+        hasher.update(file + '\0' + std::to_string(size) + '\0' + std::to_string(mtime) + '\n');
+    }
+    signature = hasher.hexDigest();
+    return files;
+}
+
+// Read a memory-mapped index; false if it is missing, malformed or built from other files
+static bool readIndex(const fs::path& indexPath, const fs::path& directory, const std::string& signature,
+                      std::vector<DirectoryFontMgr::Face>& faces) {
+    sk_sp<SkData> data = SkData::MakeFromFileName(indexPath.string().c_str());
+    if (!data || data->size() < sizeof(IndexHeader)) {
+        return false;
+    }
+
+    IndexHeader header;
+    std::memcpy(&header, data->data(), sizeof(header));
+    if (std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+        header.version != kIndexVersion ||
+        signature.size() != sizeof(header.signature) ||
+        std::memcmp(header.signature, signature.data(), sizeof(header.signature)) != 0) {
+        return false;
+    }
+    size_t facesBytes = static_cast<size_t>(header.face_count) * sizeof(IndexFace);
+    if (data->size() != sizeof(IndexHeader) + facesBytes + header.strings_size || header.strings_size == 0) {
+        return false;
+    }
+    const uint8_t* bytes = data->bytes();
+    const char* strings = reinterpret_cast<const char*>(bytes + sizeof(IndexHeader) + facesBytes);
+    if (strings[header.strings_size - 1] != '\0') {
+        return false;
+    }
+
+    faces.clear();
+    faces.reserve(header.face_count);
+    for (uint32_t i = 0; i < header.face_count; i++) {
+        IndexFace record;
+        std::memcpy(&record, bytes + sizeof(IndexHeader) + i * sizeof(IndexFace), sizeof(record));
+        if (record.path >= header.strings_size || record.family >= header.strings_size ||
+            record.postscript_name >= header.strings_size) {
+            return false;
+        }
+        DirectoryFontMgr::Face face;
+        face.path = (directory / (strings + record.path)).string();
+        face.ttc_index = record.ttc_index;
+        face.family = strings + record.family;
+        face.postscript_name = strings + record.postscript_name;
+        face.style = SkFontStyle(record.weight, record.width, static_cast<SkFontStyle::Slant>(record.slant));
+        faces.push_back(std::move(face));
+    }
+    return true;
+}
+
+// Write the index atomically; failure only costs a rescan on the next run
+static bool writeIndex(const fs::path& indexPath, const fs::path& directory, const std::string& signature,
+                       const std::vector<DirectoryFontMgr::Face>& faces) {
+    std::string strings;
+    auto addString = [&strings](const std::string& value) {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(value);
+        strings.push_back('\0');
+        return offset;
+    };
+
+    std::vector<IndexFace> records;
+    records.reserve(faces.size());
+    for (const auto& face : faces) {
+        IndexFace record;
+        record.path = addString(fs::path(face.path).lexically_relative(directory).generic_string());
+        record.family = addString(face.family);
+        record.postscript_name = addString(face.postscript_name);
+        record.ttc_index = face.ttc_index;
+        record.weight = face.style.weight();
+        record.width = face.style.width();
+        record.slant = static_cast<int32_t>(face.style.slant());
+        records.push_back(record);
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexVersion;
+    header.face_count = static_cast<uint32_t>(records.size());
+    std::memcpy(header.signature, signature.data(), std::min(signature.size(), sizeof(header.signature)));
+    header.strings_size = static_cast<uint32_t>(strings.size());
+
+    fs::path tempPath = indexPath;
+    tempPath += ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_DEBUG("Font index not written (directory not writable): " << indexPath.string());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(IndexFace));
+        out.write(strings.data(), strings.size());
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            LOG_DEBUG("Font index not written (write failed): " << indexPath.string());
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, indexPath, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        LOG_DEBUG("Font index not written (rename failed): " << indexPath.string());
+        return false;
+    }
+    LOG_DEBUG("Font index written: " << indexPath.string() << " (" << faces.size() << " faces)");
+    return true;
+}
+
+// Index location for font directories that cannot be written (read-only images, Lambda):
+// <indexDir>/<hash of the font directory path>, indexDir defaulting to the temp directory
+static fs::path fallbackIndexPath(const fs::path& directory, const std::string& indexDir) {
+    std::error_code ec;
+    fs::path base = indexDir.empty() ? fs::temp_directory_path(ec) / "lotio-font-index" : fs::path(indexDir);
+    if (ec) {
+        return fs::path();
+    }
+    return base / sha256Hex(directory.string()).substr(0, 16);
+}
+
+// Scan every face of every font file; the typefaces created while scanning are kept
+static void scanFonts(const SkFontScanner& scanner, const fs::path& directory, const std::vector<std::string>& files,
+                      std::vector<DirectoryFontMgr::Face>& faces, std::vector<sk_sp<SkTypeface>>& typefaces) {
+    for (const auto& file : files) {
+        std::string path = (directory / file).string();
+        auto stream = SkStream::MakeFromFile(path.c_str());
+        int numFaces = 0;
+        if (!stream || !scanner.scanFile(stream.get(), &numFaces)) {
+            LOG_DEBUG("Skipping unreadable font file: " << path);
+            continue;
+        }
+        for (int i = 0; i < numFaces; i++) {
+            sk_sp<SkTypeface> typeface = scanner.MakeFromStream(SkStream::MakeFromFile(path.c_str()),
+                                                                SkFontArguments().setCollectionIndex(i));
+            if (!typeface) {
+                continue;
+            }
+            DirectoryFontMgr::Face face;
+            face.path = path;
+            face.ttc_index = i;
+            SkString family;
+            typeface->getFamilyName(&family);
+            face.family = family.c_str();
+            SkString postscriptName;
+            if (typeface->getPostScriptName(&postscriptName)) {
+                face.postscript_name = postscriptName.c_str();
+            }
+            face.style = typeface->fontStyle();
+            faces.push_back(std::move(face));
+            typefaces.push_back(std::move(typeface));
+        }
+    }
+}
+
+sk_sp<DirectoryFontMgr> DirectoryFontMgr::Make(const std::string& directory, const std::string& indexDir) {
+    std::error_code ec;
+    fs::path dir = fs::absolute(directory, ec);
+    if (ec || !fs::is_directory(dir, ec)) {
+        LOG_CERR("[ERROR] Font directory does not exist: " << directory) << std::endl;
+        return nullptr;
+    }
+
+    std::string signature;
+    std::vector<std::string> files = listFontFiles(dir, signature);
+    fs::path indexPath = dir / kIndexFileName;
+    fs::path fallbackPath = fallbackIndexPath(dir, indexDir);
+
+    std::vector<Face> faces;
+    std::vector<sk_sp<SkTypeface>> typefaces;
+    bool loaded = readIndex(indexPath, dir, signature, faces);
+    if (!loaded && !fallbackPath.empty()) {
+        loaded = readIndex(fallbackPath, dir, signature, faces);
+        indexPath = fallbackPath;
+    }
+    if (loaded) {
+        LOG_DEBUG("Font index loaded: " << indexPath.string() << " (" << faces.size() << " faces)");
+        typefaces.resize(faces.size());
+    } else {
+        faces.clear();  // A malformed index may have been read partially
+        LOG_DEBUG("Building font index for " << files.size() << " font files in " << dir.string());
+        auto scanner = SkFontScanner_Make_FreeType();
+        if (!scanner) {
+            LOG_CERR("[ERROR] SkFontScanner_Make_FreeType() returned nullptr; cannot scan font directory") << std::endl;
+            return nullptr;
+        }
+        scanFonts(*scanner, dir, files, faces, typefaces);
+        if (!faces.empty() && !writeIndex(dir / kIndexFileName, dir, signature, faces) && !fallbackPath.empty()) {
+            std::error_code mkdirEc;
+            fs::create_directories(fallbackPath.parent_path(), mkdirEc);
+            writeIndex(fallbackPath, dir, signature, faces);
+        }
+    }
+
+    if (faces.empty()) {
+        LOG_CERR("[ERROR] No usable fonts found in font directory: " << directory) << std::endl;
+        return nullptr;
+    }
+    return sk_sp<DirectoryFontMgr>(new DirectoryFontMgr(std::move(faces), std::move(typefaces), std::move(signature)));
+}
+
+DirectoryFontMgr::DirectoryFontMgr(std::vector<Face> faces, std::vector<sk_sp<SkTypeface>> typefaces,
+                                   std::string signature)
+    : fScanner(SkFontScanner_Make_FreeType())
+    , fFaces(std::move(faces))
+    , fSignature(std::move(signature))
+    , fTypefaces(std::move(typefaces)) {
+    for (int i = 0; i < static_cast<int>(fFaces.size()); i++) {
+        int family = findFamily(fFaces[i].family.c_str());
+        if (family < 0) {
+            fFamilies.push_back({fFaces[i].family, {}});
+            family = static_cast<int>(fFamilies.size()) - 1;
+        }
+        fFamilies[family].faces.push_back(i);
+    }
+    std::sort(fFamilies.begin(), fFamilies.end(),
+              [](const Family& a, const Family& b) { return a.name < b.name; });
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::faceTypeface(int faceIndex) const {
+    std::lock_guard<std::mutex> lock(fTypefaceMutex);
+    sk_sp<SkTypeface>& typeface = fTypefaces[faceIndex];
+    if (!typeface && fScanner) {
+        const Face& face = fFaces[faceIndex];
+        typeface = fScanner->MakeFromStream(SkStream::MakeFromFile(face.path.c_str()),
+                                            SkFontArguments().setCollectionIndex(face.ttc_index));
+        if (!typeface) {
+            LOG_DEBUG("Failed to load font: " << face.path);
+        }
+    }
+    return typeface;
+}
+
+int DirectoryFontMgr::findFamily(const char familyName[]) const {
+    for (int i = 0; i < static_cast<int>(fFamilies.size()); i++) {
+        if (equalsIgnoreCase(fFamilies[i].name, familyName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int DirectoryFontMgr::findPostScriptName(const char name[]) const {
+    for (int i = 0; i < static_cast<int>(fFaces.size()); i++) {
+        if (!fFaces[i].postscript_name.empty() && equalsIgnoreCase(fFaces[i].postscript_name, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Style set over a subset of the faces of a DirectoryFontMgr
+class DirectoryFontStyleSet : public SkFontStyleSet {
+public:
+    DirectoryFontStyleSet(sk_sp<const DirectoryFontMgr> fontMgr, std::vector<int> faces)
+        : fFontMgr(std::move(fontMgr)), fFaces(std::move(faces)) {}
+
+    int count() override { return static_cast<int>(fFaces.size()); }
+
+    void getStyle(int index, SkFontStyle* style, SkString* name) override {
+        const auto& face = fFontMgr->face(fFaces[index]);
+        if (style) {
+            *style = face.style;
+        }
+        if (name) {
+            *name = SkString(face.postscript_name.c_str());
+        }
+    }
+
+    sk_sp<SkTypeface> createTypeface(int index) override {
+        return fFontMgr->faceTypeface(fFaces[index]);
+    }
+
+    sk_sp<SkTypeface> matchStyle(const SkFontStyle& pattern) override {
+        return this->matchStyleCSS3(pattern);
+    }
+
+private:
+    sk_sp<const DirectoryFontMgr> fFontMgr;
+    std::vector<int> fFaces;
+};
+
+int DirectoryFontMgr::onCountFamilies() const {
+    return static_cast<int>(fFamilies.size());
+}
+
+void DirectoryFontMgr::onGetFamilyName(int index, SkString* familyName) const {
+    *familyName = SkString(fFamilies[index].name.c_str());
+}
+
+sk_sp<SkFontStyleSet> DirectoryFontMgr::onCreateStyleSet(int index) const {
+    return sk_make_sp<DirectoryFontStyleSet>(sk_ref_sp(this), fFamilies[index].faces);
+}
+
+sk_sp<SkFontStyleSet> DirectoryFontMgr::onMatchFamily(const char familyName[]) const {
+    if (!familyName) {
+        return nullptr;
+    }
+    int family = findFamily(familyName);
+    if (family >= 0) {
+        return onCreateStyleSet(family);
+    }
+    int face = findPostScriptName(familyName);
+    if (face >= 0) {
+        return sk_make_sp<DirectoryFontStyleSet>(sk_ref_sp(this), std::vector<int>{face});
+    }
+    return nullptr;
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMatchFamilyStyle(const char familyName[], const SkFontStyle& style) const {
+    if (!familyName) {
+        return nullptr;
+    }
+    // A PostScript name identifies one face exactly, whatever the requested style
+    int face = findPostScriptName(familyName);
+    if (face >= 0) {
+        return faceTypeface(face);
+    }
+    int family = findFamily(familyName);
+    if (family < 0) {
+        return nullptr;
+    }
+    return onCreateStyleSet(family)->matchStyle(style);
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMatchFamilyStyleCharacter(const char familyName[], const SkFontStyle& style,
+                                                                const char* /* bcp47 */[], int /* bcp47Count */,
+                                                                SkUnichar character) const {
+    // Prefer the requested family, then any face (in index order) that has a glyph for the character
+    if (familyName) {
+        sk_sp<SkTypeface> typeface = onMatchFamilyStyle(familyName, style);
+        if (typeface && typeface->unicharToGlyph(character) != 0) {
+            return typeface;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(fFaces.size()); i++) {
+        sk_sp<SkTypeface> typeface = faceTypeface(i);
+        if (typeface && typeface->unicharToGlyph(character) != 0) {
+            return typeface;
+        }
+    }
+    return nullptr;
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMakeFromData(sk_sp<SkData> data, int ttcIndex) const {
+    return onMakeFromStreamIndex(SkMemoryStream::Make(std::move(data)), ttcIndex);
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMakeFromStreamIndex(std::unique_ptr<SkStreamAsset> stream, int ttcIndex) const {
+    return onMakeFromStreamArgs(std::move(stream), SkFontArguments().setCollectionIndex(ttcIndex));
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMakeFromStreamArgs(std::unique_ptr<SkStreamAsset> stream,
+                                                         const SkFontArguments& args) const {
+    if (!stream || !fScanner) {
+        return nullptr;
+    }
+    return fScanner->MakeFromStream(std::move(stream), args);
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onMakeFromFile(const char path[], int ttcIndex) const {
+    return onMakeFromStreamIndex(SkStream::MakeFromFile(path), ttcIndex);
+}
+
+sk_sp<SkTypeface> DirectoryFontMgr::onLegacyMakeTypeface(const char familyName[], SkFontStyle style) const {
+    if (familyName) {
+        sk_sp<SkTypeface> typeface = onMatchFamilyStyle(familyName, style);
+        if (typeface) {
+            return typeface;
+        }
+    }
+    // Default typeface: the closest style of the first family (families are sorted by name)
+    return onCreateStyleSet(0)->matchStyle(style);
+}
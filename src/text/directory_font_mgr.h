@@ -0,0 +1,77 @@
+#ifndef DIRECTORY_FONT_MGR_H
+#define DIRECTORY_FONT_MGR_H
+
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkTypeface.h"
+#include "include/ports/SkFontScanner_FreeType.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Font manager over a fixed directory of font files (.ttf/.otf/.ttc/.otc, searched recursively)
+// Does not use fontconfig. Family, style and PostScript names of every face are kept in an index
+// file (<dir>/.lotio-font-index, or a per-directory file in a writable index directory when the
+// font directory is read-only) that is memory-mapped on later runs; the index is rebuilt when
+// the set of font files (names, sizes, modification times) changes. Typefaces are loaded on
+// first use. Faces can be matched by family name or by PostScript name (Lottie "fName").
+class DirectoryFontMgr : public SkFontMgr {
+public:
+    static constexpr const char* kIndexFileName = ".lotio-font-index";
+
+    // Returns nullptr if the directory does not exist or contains no usable fonts
+    // indexDir: where to keep the index if <dir> cannot be written ("" = <temp dir>/lotio-font-index)
+    static sk_sp<DirectoryFontMgr> Make(const std::string& directory, const std::string& indexDir = "");
+
+    struct Face {
+        std::string path;
+        int ttc_index = 0;
+        std::string family;
+        std::string postscript_name;
+        SkFontStyle style;
+    };
+
+    // Create (once) the typeface of a face
+    sk_sp<SkTypeface> faceTypeface(int faceIndex) const;
+    const Face& face(int faceIndex) const { return fFaces[faceIndex]; }
+
+    // SHA-256 (hex) of the font file listing (names, sizes, modification times)
+    const std::string& signature() const { return fSignature; }
+
+protected:
+    int onCountFamilies() const override;
+    void onGetFamilyName(int index, SkString* familyName) const override;
+    sk_sp<SkFontStyleSet> onCreateStyleSet(int index) const override;
+    sk_sp<SkFontStyleSet> onMatchFamily(const char familyName[]) const override;
+    sk_sp<SkTypeface> onMatchFamilyStyle(const char familyName[], const SkFontStyle& style) const override;
+    sk_sp<SkTypeface> onMatchFamilyStyleCharacter(const char familyName[], const SkFontStyle& style,
+                                                  const char* bcp47[], int bcp47Count,
+                                                  SkUnichar character) const override;
+    sk_sp<SkTypeface> onMakeFromData(sk_sp<SkData> data, int ttcIndex) const override;
+    sk_sp<SkTypeface> onMakeFromStreamIndex(std::unique_ptr<SkStreamAsset> stream, int ttcIndex) const override;
+    sk_sp<SkTypeface> onMakeFromStreamArgs(std::unique_ptr<SkStreamAsset> stream,
+                                           const SkFontArguments& args) const override;
+    sk_sp<SkTypeface> onMakeFromFile(const char path[], int ttcIndex) const override;
+    sk_sp<SkTypeface> onLegacyMakeTypeface(const char familyName[], SkFontStyle style) const override;
+
+private:
+    struct Family {
+        std::string name;
+        std::vector<int> faces;  // Indices into fFaces
+    };
+
+    DirectoryFontMgr(std::vector<Face> faces, std::vector<sk_sp<SkTypeface>> typefaces, std::string signature);
+
+    int findFamily(const char familyName[]) const;      // -1 if not found
+    int findPostScriptName(const char name[]) const;     // Face index, -1 if not found
+
+    std::unique_ptr<SkFontScanner> fScanner;
+    std::vector<Face> fFaces;                            // Sorted by path, then collection index
+    std::vector<Family> fFamilies;                       // Sorted by name
+    std::string fSignature;
+    mutable std::mutex fTypefaceMutex;                   // Guards fTypefaces
+    mutable std::vector<sk_sp<SkTypeface>> fTypefaces;   // Per face, created on first use
+};
+
+#endif // DIRECTORY_FONT_MGR_H
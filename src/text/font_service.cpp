@@ -0,0 +1,242 @@
+#include "font_service.h"
+#include "font_utils.h"
+#include "../utils/logging.h"
+#include "../utils/sha256.h"
+#include "include/core/SkFontStyle.h"
+#ifndef __EMSCRIPTEN__
+#include "directory_font_mgr.h"
+#include "include/ports/SkFontScanner_FreeType.h"
+#include "include/ports/SkFontMgr_fontconfig.h"
+#include <fontconfig/fontconfig.h>
+#include <sys/stat.h>
+#endif
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+// Font manager: Use fontconfig (handles both system fonts and custom fonts via fontconfig)
+// Custom fonts in /usr/local/share/fonts should be registered via fc-cache
+static sk_sp<SkFontMgr> createFontManager() {
+    LOG_DEBUG("Setting up font manager...");
+    sk_sp<SkFontMgr> fontMgr;
+
+#ifndef __EMSCRIPTEN__
+    try {
+        const auto fcInitOk = FcInit();
+        LOG_DEBUG("FcInit() returned " << (fcInitOk ? "true" : "false"));
+
+        auto scanner = SkFontScanner_Make_FreeType();
+        if (!scanner) {
+            LOG_CERR("[ERROR] SkFontScanner_Make_FreeType() returned nullptr; cannot use fontconfig") << std::endl;
+        } else {
+            fontMgr = SkFontMgr_New_FontConfig(nullptr, std::move(scanner));
+            if (fontMgr) {
+                LOG_DEBUG("Fontconfig font manager created successfully");
+                LOG_DEBUG("Fontconfig will find system fonts and custom fonts (if registered via fc-cache)");
+            } else {
+                LOG_CERR("[ERROR] Failed to create fontconfig font manager") << std::endl;
+            }
+        }
+    } catch (...) {
+        LOG_CERR("[ERROR] Exception creating fontconfig font manager") << std::endl;
+        fontMgr = nullptr;
+    }
+#endif
+
+    if (!fontMgr) {
+        fontMgr = SkFontMgr::RefEmpty();
+    }
+    return fontMgr;
+}
+
+static std::mutex g_fontMgrMutex;
+static sk_sp<SkFontMgr> g_fontMgr;  // Created once, on first use or by useFontDirectory()
+static std::string g_fontDirectorySignature;  // Set by useFontDirectory()
+
+sk_sp<SkFontMgr> sharedFontManager() {
+    std::lock_guard<std::mutex> lock(g_fontMgrMutex);
+    if (!g_fontMgr) {
+        g_fontMgr = createFontManager();
+    }
+    return g_fontMgr;
+}
+
+bool useFontDirectory(const std::string& directory, const std::string& indexDir) {
+#ifndef __EMSCRIPTEN__
+    std::lock_guard<std::mutex> lock(g_fontMgrMutex);
+    if (g_fontMgr) {
+        LOG_CERR("[ERROR] Font directory must be set before the font manager is first used") << std::endl;
+        return false;
+    }
+    sk_sp<DirectoryFontMgr> fontMgr = DirectoryFontMgr::Make(directory, indexDir);
+    if (!fontMgr) {
+        return false;
+    }
+    LOG_DEBUG("Using directory font manager (fontconfig disabled): " << directory);
+    g_fontDirectorySignature = fontMgr->signature();
+    g_fontMgr = std::move(fontMgr);
+    return true;
+#else
+    (void)directory;
+    (void)indexDir;
+    return false;
+#endif
+}
+
+#ifndef __EMSCRIPTEN__
+// Files of the fonts fontconfig serves (system and application sets), with sizes and mtimes
+static std::string fontconfigSignature() {
+    std::vector<std::string> files;
+    FcConfig* config = FcConfigGetCurrent();
+    for (FcSetName setName : {FcSetSystem, FcSetApplication}) {
+        FcFontSet* fontSet = config ? FcConfigGetFonts(config, setName) : nullptr;
+        for (int i = 0; fontSet && i < fontSet->nfont; i++) {
+            FcChar8* file = nullptr;
+            if (FcPatternGetString(fontSet->fonts[i], FC_FILE, 0, &file) == FcResultMatch && file) {
+                files.emplace_back(reinterpret_cast<const char*>(file));
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    Sha256 hasher;
+    for (const auto& file : files) {
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0) {
+            st.st_size = -1;
+            st.st_mtime = 0;
+        }
+        hasher.update(file + '\0' + std::to_string(st.st_size) + '\0' + std::to_string(st.st_mtime) + '\n');
+    }
+    return "fontconfig:" + hasher.hexDigest();
+}
+#endif
+
+std::string fontConfigurationSignature() {
+#ifndef __EMSCRIPTEN__
+    sharedFontManager();  // Fixes the font source (and initializes fontconfig)
+    static std::mutex mutex;
+    static std::string signature;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (signature.empty()) {
+        {
+            std::lock_guard<std::mutex> mgrLock(g_fontMgrMutex);
+            signature = g_fontDirectorySignature;
+        }
+        signature = signature.empty() ? fontconfigSignature() : "directory:" + signature;
+    }
+    return signature;
+#else
+    return "";
+#endif
+}
+
+static sk_sp<SkTypeface> matchTypeface(
+    SkFontMgr* fontMgr,
+    const std::string& fontFamily,
+    const std::string& fontStyle,
+    const std::string& fontName
+) {
+    // Try to get typeface using family and style
+    sk_sp<SkTypeface> typeface = fontMgr->matchFamilyStyle(
+        fontFamily.c_str(),
+        getSkFontStyle(fontStyle)
+    );
+
+    // Fallback: try with full font name
+    if (!typeface) {
+        typeface = fontMgr->matchFamilyStyle(fontName.c_str(), SkFontStyle::Normal());
+    }
+
+    // Last resort: try legacy method
+    if (!typeface) {
+        typeface = fontMgr->legacyMakeTypeface(fontName.c_str(), SkFontStyle::Normal());
+    }
+
+    if (!typeface) {
+        LOG_DEBUG("Warning: Could not find typeface for " << fontName << ", using default");
+        typeface = fontMgr->legacyMakeTypeface(nullptr, SkFontStyle::Normal());
+    }
+    return typeface;
+}
+
+sk_sp<SkTypeface> TypefaceResolver::resolve(
+    const std::string& fontFamily,
+    const std::string& fontStyle,
+    const std::string& fontName
+) {
+    Key key(fontFamily, fontStyle, fontName);
+    {
+        std::shared_lock<std::shared_mutex> lock(fMutex);
+        auto it = fResolved.find(key);
+        if (it != fResolved.end()) {
+            fHits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(fMutex);
+    auto it = fResolved.find(key);
+    if (it != fResolved.end()) {
+        fHits.fetch_add(1, std::memory_order_relaxed);
+        return it->second;  // Resolved by another thread meanwhile
+    }
+    fMisses.fetch_add(1, std::memory_order_relaxed);
+    sk_sp<SkTypeface> typeface = matchTypeface(fFontMgr.get(), fontFamily, fontStyle, fontName);
+    fResolved.emplace(std::move(key), typeface);
+    return typeface;
+}
+
+sk_sp<SkTypeface> TypefaceResolver::findByName(const std::string& fontName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(fMutex);
+        auto it = fNamed.find(fontName);
+        if (it != fNamed.end()) {
+            fHits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(fMutex);
+    auto it = fNamed.find(fontName);
+    if (it != fNamed.end()) {
+        fHits.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+    fMisses.fetch_add(1, std::memory_order_relaxed);
+    sk_sp<SkTypeface> typeface = fFontMgr->matchFamilyStyle(fontName.c_str(), SkFontStyle::Normal());
+    if (!typeface) {
+        typeface = fFontMgr->legacyMakeTypeface(fontName.c_str(), SkFontStyle::Normal());
+    }
+    fNamed.emplace(fontName, typeface);
+    return typeface;
+}
+
+void TypefaceResolver::clear() {
+    std::unique_lock<std::shared_mutex> lock(fMutex);
+    fResolved.clear();
+    fNamed.clear();
+}
+
+TypefaceResolver& sharedTypefaceResolver() {
+    static TypefaceResolver resolver(sharedFontManager());
+    return resolver;
+}
+
+sk_sp<SkTypeface> resolveTypeface(
+    SkFontMgr* fontMgr,
+    const std::string& fontFamily,
+    const std::string& fontStyle,
+    const std::string& fontName
+) {
+    TypefaceResolver& shared = sharedTypefaceResolver();
+    if (fontMgr != shared.fontManager()) {
+        return matchTypeface(fontMgr, fontFamily, fontStyle, fontName);
+    }
+    return shared.resolve(fontFamily, fontStyle, fontName);
+}
+
+sk_sp<SkTypeface> findTypefaceByName(const std::string& fontName) {
+    return sharedTypefaceResolver().findByName(fontName);
+}
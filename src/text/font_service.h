@@ -0,0 +1,78 @@
+#ifndef FONT_SERVICE_H
+#define FONT_SERVICE_H
+
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkTypeface.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+
+// Process-wide font manager shared by text measurement and the Skottie builder
+// Created on first use, so fontconfig initialization and the font scan happen once per process.
+// Falls back to an empty font manager when fontconfig is unavailable (always the case in WASM).
+sk_sp<SkFontMgr> sharedFontManager();
+
+// Serve fonts from a directory instead of fontconfig (see DirectoryFontMgr)
+// indexDir: where to keep the font index if the directory is read-only ("" = temp directory)
+// Must be called before the shared font manager is first used; returns false if it already was,
+// or if the directory has no usable fonts (not supported in WASM)
+bool useFontDirectory(const std::string& directory, const std::string& indexDir = "");
+
+// Signature of the fonts the shared font manager can serve: the font directory's file listing
+// with --font-dir, otherwise the files fontconfig knows with their sizes and modification times
+// Computed once per process; changes whenever fonts are added, removed or replaced ("" in WASM)
+std::string fontConfigurationSignature();
+
+// Typeface resolution for a Lottie font against one font manager: family + style, then the full
+// font name, then the default typeface. Every resolution is memoized by (family, style, name),
+// misses included (a font that is not installed resolves once to its fallback), so the repeated
+// measurements of a font-size search never reach font matching again.
+// Thread-safe: hits take a shared lock; a miss is resolved once under the exclusive lock.
+class TypefaceResolver {
+public:
+    explicit TypefaceResolver(sk_sp<SkFontMgr> fontMgr) : fFontMgr(std::move(fontMgr)) {}
+
+    sk_sp<SkTypeface> resolve(const std::string& fontFamily, const std::string& fontStyle, const std::string& fontName);
+
+    // Installed font by name (nullptr if not installed)
+    sk_sp<SkTypeface> findByName(const std::string& fontName);
+
+    // Forget all resolutions (e.g. after fonts were added to the font manager)
+    void clear();
+
+    SkFontMgr* fontManager() const { return fFontMgr.get(); }
+    uint64_t hits() const { return fHits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return fMisses.load(std::memory_order_relaxed); }
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+    const sk_sp<SkFontMgr> fFontMgr;
+    std::shared_mutex fMutex;
+    std::map<Key, sk_sp<SkTypeface>> fResolved;
+    std::map<std::string, sk_sp<SkTypeface>> fNamed;  // Null entries record misses
+    std::atomic<uint64_t> fHits{0};
+    std::atomic<uint64_t> fMisses{0};
+};
+
+// Resolver over the shared font manager (created with it)
+TypefaceResolver& sharedTypefaceResolver();
+
+// Resolve the typeface for a Lottie font (see TypefaceResolver)
+// Resolutions against the shared font manager go through sharedTypefaceResolver(), so each
+// typeface is loaded once per process; other font managers (e.g. WASM fonts registered at
+// runtime) are queried directly.
+sk_sp<SkTypeface> resolveTypeface(
+    SkFontMgr* fontMgr,
+    const std::string& fontFamily,
+    const std::string& fontStyle,
+    const std::string& fontName
+);
+
+// Find an installed font by name in the shared font manager (nullptr if not installed; memoized)
+sk_sp<SkTypeface> findTypefaceByName(const std::string& fontName);
+
+#endif // FONT_SERVICE_H
@@ -1,4 +1,7 @@
 #include "font_utils.h"
+#include "font_service.h"
+#include "glyph_run_cache.h"
+#include "../core/pixel_convert.h"
 #include "../utils/string_utils.h"
 #include "../utils/logging.h"
 #include "include/core/SkFont.h"
@@ -26,11 +29,35 @@ SkFontStyle getSkFontStyle(const std::string& styleStr) {
     return SkFontStyle::Normal();
 }
 
+// Scratch raster surface for PIXEL_PERFECT measurement, one per thread, reused across calls
+// Grows (with some headroom, so the sizes of a font-size search share it) up to kMaxScratchPixels;
+// larger requests get a temporary surface in `oversized`.
+static constexpr int64_t kMaxScratchPixels = 4 * 1024 * 1024;
+
+static SkSurface* scratchSurface(int width, int height, sk_sp<SkSurface>& oversized) {
+    thread_local sk_sp<SkSurface> scratch;
+    if (scratch && scratch->width() >= width && scratch->height() >= height) {
+        return scratch.get();
+    }
+    if (static_cast<int64_t>(width) * height > kMaxScratchPixels) {
+        oversized = SkSurfaces::Raster(SkImageInfo::MakeN32(width, height, kPremul_SkAlphaType));
+        return oversized.get();
+    }
+    int scratchWidth = std::max(width + width / 4, scratch ? scratch->width() : 0);
+    int scratchHeight = std::max(height + height / 4, scratch ? scratch->height() : 0);
+    if (static_cast<int64_t>(scratchWidth) * scratchHeight > kMaxScratchPixels) {
+        scratchWidth = width;
+        scratchHeight = height;
+    }
+    scratch = SkSurfaces::Raster(SkImageInfo::MakeN32(scratchWidth, scratchHeight, kPremul_SkAlphaType));
+    return scratch.get();
+}
+
 // Helper function to measure rendered text width by scanning pixels (PIXEL_PERFECT mode)
 // This measures the full text advance width including spacing, kerning, and glyph widths
 static SkScalar measureRenderedTextWidth(sk_sp<SkTextBlob> blob, const SkFont& font, const SkRect& blobBounds) {
-    // Create an off-screen surface to render the text
-    // Use a surface that's wide enough to capture the full advance width
+    // Render into the thread's scratch surface, clipped to an area wide enough to capture the
+    // full advance width
     int padding = 20;  // Extra padding for anti-aliasing
     int surfaceWidth = static_cast<int>(std::ceil(blobBounds.width() + std::abs(blobBounds.left()) + padding * 2));
     int surfaceHeight = static_cast<int>(std::ceil(blobBounds.height())) + padding * 2;
@@ -42,13 +69,8 @@ static SkScalar measureRenderedTextWidth(sk_sp<SkTextBlob> blob, const SkFont& f
         return blobBounds.width();
     }
     
-    SkImageInfo info = SkImageInfo::MakeN32(
-        surfaceWidth,
-        surfaceHeight,
-        kPremul_SkAlphaType
-    );
-    
-    auto surface = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> oversized;
+    SkSurface* surface = scratchSurface(surfaceWidth, surfaceHeight, oversized);
     if (!surface) {
         // Fallback to blob bounds if surface creation fails
         if (g_debug_mode) {
@@ -58,6 +80,8 @@ static SkScalar measureRenderedTextWidth(sk_sp<SkTextBlob> blob, const SkFont& f
     }
     
     SkCanvas* canvas = surface->getCanvas();
+    canvas->save();
+    canvas->clipRect(SkRect::MakeWH(static_cast<float>(surfaceWidth), static_cast<float>(surfaceHeight)));
     canvas->clear(SK_ColorTRANSPARENT);
     
     // Render the text starting at a known position (accounting for left side bearing)
@@ -71,45 +95,24 @@ static SkScalar measureRenderedTextWidth(sk_sp<SkTextBlob> blob, const SkFont& f
     float xStart = padding - blobBounds.left();  // Start position accounting for left bearing
     float yStart = padding - blobBounds.top();
     canvas->drawTextBlob(blob, xStart, yStart, paint);
+    canvas->restore();
     
-    // Get the image and find actual rendered bounds
-    sk_sp<SkImage> image = surface->makeImageSnapshot();
-    if (!image) {
-        if (g_debug_mode) {
-            LOG_DEBUG("[PIXEL_PERFECT] Fallback: image snapshot failed, using blobBounds.width(): " << blobBounds.width());
-        }
-        return blobBounds.width();
-    }
-    
-    // Read pixels and find actual rendered bounds
+    // Read the pixels in place (raster surfaces draw immediately)
     SkPixmap pixmap;
-    if (!image->peekPixels(&pixmap)) {
+    if (!surface->peekPixels(&pixmap)) {
         if (g_debug_mode) {
             LOG_DEBUG("[PIXEL_PERFECT] Fallback: peekPixels failed, using blobBounds.width(): " << blobBounds.width());
         }
         return blobBounds.width();
     }
     
-    // Find rightmost non-transparent pixel (from the start position)
+    // Find rightmost non-transparent pixel column (from the start position)
     // This gives us the full advance width including all spacing and kerning
-    int rightmostPixel = 0;
-    bool foundPixel = false;
-    
-    // Scan from the start position to find the rightmost pixel
-    // This accounts for the full text width including spacing
     int startX = static_cast<int>(xStart);
-    for (int y = 0; y < pixmap.height(); y++) {
-        const uint32_t* row = pixmap.addr32(0, y);
-        for (int x = startX; x < pixmap.width(); x++) {
-            SkColor color = row[x];
-            if (SkColorGetA(color) > 0) {  // Non-transparent pixel
-                rightmostPixel = std::max(rightmostPixel, x);
-                foundPixel = true;
-            }
-        }
-    }
+    int rightmostPixel = rightmostCoveredColumn(static_cast<const uint8_t*>(pixmap.addr()), pixmap.rowBytes(),
+                                                surfaceWidth, surfaceHeight, startX);
     
-    if (foundPixel && rightmostPixel >= startX) {
+    if (rightmostPixel >= startX) {
         // Measure from start position to rightmost pixel
         // This gives us the full advance width including spacing, kerning, and glyph widths
         SkScalar renderedWidth = static_cast<SkScalar>(rightmostPixel - startX + 1) + 1.0f;  // +1px safety margin
@@ -132,6 +135,45 @@ static SkScalar measureRenderedTextWidth(sk_sp<SkTextBlob> blob, const SkFont& f
     return blobBounds.width();
 }
 
+// Width of one line from its cached glyphs
+// Matches what the measurement did on the UTF-8 line: FAST is SkFont::measureText bounds, which
+// for glyph IDs are the same glyph bounds laid out at their advances. ACCURATE is the bounds of
+// the SkTextBlob::MakeFromString blob, a fully positioned run whose bounds are conservative: the
+// glyph origins widened by the typeface's bounding box (tight glyph bounds if the typeface has
+// none), computed here without building the blob. Skia applies no kerning to either.
+static SkScalar measureGlyphLine(const SkFont& font, const GlyphLines::Line& line, TextMeasurementMode mode) {
+    if (line.glyphs.empty()) {
+        SkRect bounds;
+        font.measureText(line.text.c_str(), line.text.length(), SkTextEncoding::kUTF8, &bounds);
+        return bounds.width();
+    }
+
+    const SkGlyphID* glyphs = line.glyphs.data();
+    const size_t byteLength = line.glyphs.size() * sizeof(SkGlyphID);
+
+    if (mode == TextMeasurementMode::PIXEL_PERFECT) {
+        sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromText(glyphs, byteLength, font, SkTextEncoding::kGlyphID);
+        if (!blob) {
+            SkRect bounds;
+            font.measureText(glyphs, byteLength, SkTextEncoding::kGlyphID, &bounds);
+            return bounds.width();
+        }
+        return measureRenderedTextWidth(blob, font, blob->bounds());
+    }
+
+    SkTypeface* typeface = font.getTypeface();
+    SkRect typefaceBounds = typeface ? typeface->getBounds() : SkRect::MakeEmpty();
+    if (mode == TextMeasurementMode::FAST || typefaceBounds.isEmpty()) {
+        SkRect bounds;
+        font.measureText(glyphs, byteLength, SkTextEncoding::kGlyphID, &bounds);
+        return bounds.width();
+    }
+
+    // Origin of the last glyph: the advances of all glyphs before it
+    SkScalar lastOrigin = font.measureText(glyphs, byteLength - sizeof(SkGlyphID), SkTextEncoding::kGlyphID);
+    return lastOrigin + typefaceBounds.width() * font.getSize();
+}
+
 SkScalar measureTextWidth(
     SkFontMgr* fontMgr,
     const std::string& fontFamily,
@@ -141,26 +183,11 @@ SkScalar measureTextWidth(
     const std::string& text,
     TextMeasurementMode mode
 ) {
-    // Try to get typeface using family and style
-    sk_sp<SkTypeface> typeface = fontMgr->matchFamilyStyle(
-        fontFamily.c_str(),
-        getSkFontStyle(fontStyle)
-    );
-    
-    // Fallback: try with full font name
-    if (!typeface) {
-        typeface = fontMgr->matchFamilyStyle(fontName.c_str(), SkFontStyle::Normal());
+    if (mode == TextMeasurementMode::HYBRID) {
+        mode = TextMeasurementMode::PIXEL_PERFECT;  // Only the font-size search uses ACCURATE
     }
     
-    // Last resort: try legacy method
-    if (!typeface) {
-        typeface = fontMgr->legacyMakeTypeface(fontName.c_str(), SkFontStyle::Normal());
-    }
-    
-    if (!typeface) {
-        LOG_DEBUG("Warning: Could not find typeface for " << fontName << ", using default");
-        typeface = fontMgr->legacyMakeTypeface(nullptr, SkFontStyle::Normal());
-    }
+    sk_sp<SkTypeface> typeface = resolveTypeface(fontMgr, fontFamily, fontStyle, fontName);
     
     SkFont font(typeface, fontSize);
     
@@ -171,130 +198,35 @@ SkScalar measureTextWidth(
         font.setHinting(SkFontHinting::kNormal);
     }
     
-    // Split text by newlines (\r or \n) and measure each line
+    // Measure each line (split at \r, \n and \r\n, mapped to glyphs once per typeface and text)
     // Return the width of the longest line
-    SkScalar maxWidth = 0.0f;
-    std::string currentLine;
-    
-    for (size_t i = 0; i <= text.length(); i++) {
-        if (i == text.length() || text[i] == '\r' || text[i] == '\n') {
-            // Measure current line
-            if (!currentLine.empty()) {
-                SkScalar width = 0.0f;
-                
-                if (mode == TextMeasurementMode::FAST) {
-                    // FAST mode: Use measureText() with bounds (current implementation)
-                    SkRect bounds;
-                    font.measureText(currentLine.c_str(), currentLine.length(), SkTextEncoding::kUTF8, &bounds);
-                    width = bounds.width();
-                } else {
-                    // ACCURATE or PIXEL_PERFECT mode: Use SkTextBlob
-                    sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromString(
-                        currentLine.c_str(),
-                        font
-                    );
-                    
-                    if (blob) {
-                        SkRect blobBounds = blob->bounds();
-                        
-                        if (mode == TextMeasurementMode::ACCURATE) {
-                            // ACCURATE mode: Use blob bounds
-                            width = blobBounds.width();
-                        } else {
-                            // PIXEL_PERFECT mode: Render and measure actual pixels
-                            width = measureRenderedTextWidth(blob, font, blobBounds);
-                        }
-                    } else {
-                        // Fallback if blob creation fails
-                        SkRect bounds;
-                        font.measureText(currentLine.c_str(), currentLine.length(), SkTextEncoding::kUTF8, &bounds);
-                        width = bounds.width();
-                    }
-                }
-                
-                maxWidth = std::max(maxWidth, width);
-                if (g_debug_mode && (text.find('\n') != std::string::npos || text.find('\r') != std::string::npos)) {
-                    LOG_COUT("[DEBUG] Measured line: \"" << currentLine << "\" width: " << width << " (mode: " << (mode == TextMeasurementMode::FAST ? "FAST" : (mode == TextMeasurementMode::ACCURATE ? "ACCURATE" : "PIXEL_PERFECT")) << ")") << std::endl;
-                }
-            }
-            currentLine.clear();
-            
-            // Skip \r\n combination
-            if (i < text.length() && text[i] == '\r' && i + 1 < text.length() && text[i + 1] == '\n') {
-                i++;  // Skip the \n
-            }
-        } else {
-            currentLine += text[i];
-        }
-    }
+    std::shared_ptr<const GlyphLines> glyphLines = sharedGlyphRunCache().lines(font, text);
+    const bool multiline = text.find('\n') != std::string::npos || text.find('\r') != std::string::npos;
     
-    // Handle last line if text doesn't end with newline
-    if (!currentLine.empty()) {
-        SkScalar width = 0.0f;
-        
-        if (mode == TextMeasurementMode::FAST) {
-            SkRect bounds;
-            font.measureText(currentLine.c_str(), currentLine.length(), SkTextEncoding::kUTF8, &bounds);
-            width = bounds.width();
-        } else {
-            sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromString(
-                currentLine.c_str(),
-                font
-            );
-            
-            if (blob) {
-                SkRect blobBounds = blob->bounds();
-                
-                if (mode == TextMeasurementMode::ACCURATE) {
-                    width = blobBounds.width();
-                } else {
-                    width = measureRenderedTextWidth(blob, font, blobBounds);
-                }
-            } else {
-                SkRect bounds;
-                font.measureText(currentLine.c_str(), currentLine.length(), SkTextEncoding::kUTF8, &bounds);
-                width = bounds.width();
-            }
-        }
-        
+    SkScalar maxWidth = 0.0f;
+    for (const GlyphLines::Line& line : glyphLines->lines) {
+        SkScalar width = measureGlyphLine(font, line, mode);
         maxWidth = std::max(maxWidth, width);
-        if (g_debug_mode && (text.find('\n') != std::string::npos || text.find('\r') != std::string::npos)) {
-            LOG_COUT("[DEBUG] Measured line: \"" << currentLine << "\" width: " << width << " (mode: " << (mode == TextMeasurementMode::FAST ? "FAST" : (mode == TextMeasurementMode::ACCURATE ? "ACCURATE" : "PIXEL_PERFECT")) << ")") << std::endl;
+        if (g_debug_mode && multiline) {
+            LOG_COUT("[DEBUG] Measured line: \"" << line.text << "\" width: " << width << " (mode: " << (mode == TextMeasurementMode::FAST ? "FAST" : (mode == TextMeasurementMode::ACCURATE ? "ACCURATE" : "PIXEL_PERFECT")) << ")") << std::endl;
         }
     }
     
-    if (g_debug_mode && (text.find('\n') != std::string::npos || text.find('\r') != std::string::npos)) {
+    if (g_debug_mode && multiline) {
         LOG_COUT("[DEBUG] Multiline text - longest line width: " << maxWidth) << std::endl;
     }
     
     return maxWidth;
 }
 
-FontInfo extractFontInfoFromJson(const std::string& json, const std::string& layerName) {
+FontInfo extractFontInfoFromJson(const nlohmann::json& j, const LayerIndex& layers, const std::string& layerName) {
     FontInfo info;
     info.size = 0.0f;
     info.textBoxWidth = 0.0f;  // Initialize to 0 to avoid garbage values
     
     try {
-        nlohmann::json j = nlohmann::json::parse(json);
-        
-        // Find the layer by name
-        if (!j.contains("layers") || !j["layers"].is_array()) {
-            LOG_DEBUG("No layers array found in JSON");
-            return info;
-        }
-        
-        nlohmann::json* foundLayer = nullptr;
-        for (auto& layer : j["layers"]) {
-            if (layer.contains("nm") && layer["nm"].is_string() && layer["nm"].get<std::string>() == layerName) {
-                // Check if it's a text layer (ty:5)
-                if (layer.contains("ty") && layer["ty"].is_number() && layer["ty"].get<int>() == 5) {
-                    foundLayer = &layer;
-                    break;
-                }
-            }
-        }
-        
+        // Find the text layer (ty:5) by name (top-level or inside a precomp)
+        const nlohmann::json* foundLayer = layers.findTextLayer(layerName);
         if (foundLayer == nullptr) {
             LOG_DEBUG("Layer " << layerName << " not found or not a text layer (ty:5)");
             return info;
@@ -302,7 +234,7 @@ FontInfo extractFontInfoFromJson(const std::string& json, const std::string& lay
         
         // Extract text style from layers[i]["t"]["d"]["k"][0]["s"]
         if (foundLayer->contains("t") && (*foundLayer)["t"].is_object()) {
-            auto& t = (*foundLayer)["t"];
+            const auto& t = (*foundLayer)["t"];
             if (t.contains("d") && t["d"].is_object()) {
                 auto& d = t["d"];
                 if (d.contains("k") && d["k"].is_array() && d["k"].size() > 0) {
@@ -362,7 +294,7 @@ FontInfo extractFontInfoFromJson(const std::string& json, const std::string& lay
             }
         }
     } catch (const nlohmann::json::exception& e) {
-        LOG_DEBUG("Failed to parse JSON in extractFontInfoFromJson: " << e.what());
+        LOG_DEBUG("Failed to read JSON in extractFontInfoFromJson: " << e.what());
     }
     
     return info;
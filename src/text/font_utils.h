@@ -4,12 +4,15 @@
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkScalar.h"
 #include <string>
+#include <nlohmann/json.hpp>
+#include "layer_index.h"
 
 // Text measurement mode - controls accuracy vs performance trade-off
 enum class TextMeasurementMode {
     FAST,          // Uses measureText() - fastest, basic accuracy
     ACCURATE,      // Uses SkTextBlob bounds - good balance, accounts for kerning and glyph metrics
-    PIXEL_PERFECT  // Renders text and measures actual pixels - most accurate, accounts for anti-aliasing
+    PIXEL_PERFECT, // Renders text and measures actual pixels - most accurate, accounts for anti-aliasing
+    HYBRID         // Font-size search with ACCURATE, result verified with PIXEL_PERFECT (see text_sizing.h)
 };
 
 // Extract font info from Lottie JSON for a text layer
@@ -26,7 +29,7 @@ struct FontInfo {
 SkFontStyle getSkFontStyle(const std::string& styleStr);
 
 // Measure text width with given font
-// mode: Measurement accuracy mode (default: ACCURATE for good balance)
+// mode: Measurement accuracy mode (default: ACCURATE for good balance); HYBRID measures as PIXEL_PERFECT
 SkScalar measureTextWidth(
     SkFontMgr* fontMgr,
     const std::string& fontFamily,
@@ -37,8 +40,9 @@ SkScalar measureTextWidth(
     TextMeasurementMode mode = TextMeasurementMode::ACCURATE
 );
 
-// Extract font info from Lottie JSON for a text layer
-FontInfo extractFontInfoFromJson(const std::string& json, const std::string& layerName);
+// Extract font info from a parsed Lottie JSON for a text layer
+// layers: index of j's layers (the text layer may be top-level or inside a precomp)
+FontInfo extractFontInfoFromJson(const nlohmann::json& j, const LayerIndex& layers, const std::string& layerName);
 
 #endif // FONT_UTILS_H
 
@@ -0,0 +1,76 @@
+#include "glyph_run_cache.h"
+#include "include/core/SkTextBlob.h"
+#include <mutex>
+
+// Glyph IDs of a line exactly as SkTextBlob::MakeFromString maps them
+static std::vector<SkGlyphID> lineGlyphs(const SkFont& font, const std::string& line) {
+    std::vector<SkGlyphID> glyphs;
+    sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromString(line.c_str(), font);
+    if (!blob) {
+        return glyphs;
+    }
+    SkTextBlob::Iter it(*blob);
+    SkTextBlob::Iter::Run run;
+    while (it.next(&run)) {
+        glyphs.insert(glyphs.end(), run.fGlyphIndices, run.fGlyphIndices + run.fGlyphCount);
+    }
+    return glyphs;
+}
+
+static std::shared_ptr<const GlyphLines> mapGlyphLines(const SkFont& font, const std::string& text) {
+    auto result = std::make_shared<GlyphLines>();
+    std::string currentLine;
+    for (size_t i = 0; i <= text.length(); i++) {
+        if (i == text.length() || text[i] == '\r' || text[i] == '\n') {
+            if (!currentLine.empty()) {
+                std::vector<SkGlyphID> glyphs = lineGlyphs(font, currentLine);
+                result->lines.push_back({std::move(currentLine), std::move(glyphs)});
+            }
+            currentLine.clear();
+
+            // Skip \r\n combination
+            if (i < text.length() && text[i] == '\r' && i + 1 < text.length() && text[i + 1] == '\n') {
+                i++;
+            }
+        } else {
+            currentLine += text[i];
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<const GlyphLines> GlyphRunCache::lines(const SkFont& font, const std::string& text) {
+    SkTypeface* typeface = font.getTypeface();
+    Key key(typeface ? typeface->uniqueID() : 0, text);
+    {
+        std::shared_lock<std::shared_mutex> lock(fMutex);
+        auto it = fLines.find(key);
+        if (it != fLines.end()) {
+            fHits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(fMutex);
+    auto it = fLines.find(key);
+    if (it != fLines.end()) {
+        fHits.fetch_add(1, std::memory_order_relaxed);
+        return it->second;  // Mapped by another thread meanwhile
+    }
+    fMisses.fetch_add(1, std::memory_order_relaxed);
+    if (fLines.size() >= kMaxEntries) {
+        fLines.clear();
+    }
+    std::shared_ptr<const GlyphLines> glyphLines = mapGlyphLines(font, text);
+    fLines.emplace(std::move(key), glyphLines);
+    return glyphLines;
+}
+
+void GlyphRunCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(fMutex);
+    fLines.clear();
+}
+
+GlyphRunCache& sharedGlyphRunCache() {
+    static GlyphRunCache cache;
+    return cache;
+}
@@ -0,0 +1,53 @@
+#ifndef GLYPH_RUN_CACHE_H
+#define GLYPH_RUN_CACHE_H
+
+#include "include/core/SkFont.h"
+#include "include/core/SkTypeface.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Glyphs of a text for one typeface, split into lines at \r, \n and \r\n (empty lines dropped)
+struct GlyphLines {
+    struct Line {
+        std::string text;
+        std::vector<SkGlyphID> glyphs;  // Empty if the line maps to no glyphs (e.g. invalid UTF-8)
+    };
+    std::vector<Line> lines;
+};
+
+// Text-to-glyph mapping memoized by (typeface, text)
+// The mapping does not depend on the font size, so a font-size search maps its text once and
+// every further measurement only reads glyph metrics, which Skia caches per size.
+// Thread-safe: hits take a shared lock; a miss is mapped once under the exclusive lock. The cache
+// is emptied when it grows past kMaxEntries texts.
+class GlyphRunCache {
+public:
+    static constexpr size_t kMaxEntries = 4096;
+
+    // Glyph lines of text for the font's typeface (never nullptr)
+    std::shared_ptr<const GlyphLines> lines(const SkFont& font, const std::string& text);
+
+    void clear();
+
+    uint64_t hits() const { return fHits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return fMisses.load(std::memory_order_relaxed); }
+
+private:
+    using Key = std::pair<SkTypefaceID, std::string>;
+
+    std::shared_mutex fMutex;
+    std::map<Key, std::shared_ptr<const GlyphLines>> fLines;
+    std::atomic<uint64_t> fHits{0};
+    std::atomic<uint64_t> fMisses{0};
+};
+
+// Process-wide glyph run cache used by measureTextWidth()
+GlyphRunCache& sharedGlyphRunCache();
+
+#endif // GLYPH_RUN_CACHE_H
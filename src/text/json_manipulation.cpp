@@ -5,7 +5,7 @@
 #include <cmath>
 
 void adjustTextAnimatorPosition(
-    std::string& json,
+    const LayerIndex& layers,
     const std::string& layerName,
     float widthDiff
 ) {
@@ -14,21 +14,8 @@ void adjustTextAnimatorPosition(
     }
     
     try {
-        nlohmann::json j = nlohmann::json::parse(json);
-        
-        // Find the layer by name
-        if (!j.contains("layers") || !j["layers"].is_array()) {
-            return;
-        }
-        
-        nlohmann::json* foundLayer = nullptr;
-        for (auto& layer : j["layers"]) {
-            if (layer.contains("nm") && layer["nm"].is_string() && layer["nm"].get<std::string>() == layerName) {
-                foundLayer = &layer;
-                break;
-            }
-        }
-        
+        // Find the layer by name (top-level or inside a precomp)
+        nlohmann::json* foundLayer = layers.findLayer(layerName);
         if (foundLayer == nullptr) {
             return;  // Layer not found
         }
@@ -67,9 +54,6 @@ void adjustTextAnimatorPosition(
                                             }
                                         }
                                     }
-                                    
-                                    // Serialize back to JSON
-                                    json = j.dump(4);
                                     return;  // Found and adjusted, done
                                 }
                             }
@@ -80,39 +64,20 @@ void adjustTextAnimatorPosition(
         }
     } catch (const nlohmann::json::exception& e) {
         if (g_debug_mode) {
-            LOG_COUT("[DEBUG] Error parsing JSON in adjustTextAnimatorPosition: " << e.what()) << std::endl;
+            LOG_COUT("[DEBUG] Error adjusting JSON in adjustTextAnimatorPosition: " << e.what()) << std::endl;
         }
     }
 }
 
 void modifyTextLayerInJson(
-    std::string& json,
+    const LayerIndex& layers,
     const std::string& layerName,
     const std::string& newText,
     float newSize
 ) {
     try {
-        nlohmann::json j = nlohmann::json::parse(json);
-        
-        // Find the layer by name
-        if (!j.contains("layers") || !j["layers"].is_array()) {
-            if (g_debug_mode) {
-                LOG_COUT("[DEBUG] Warning: No layers array found in JSON") << std::endl;
-            }
-            return;
-        }
-        
-        nlohmann::json* foundLayer = nullptr;
-        for (auto& layer : j["layers"]) {
-            if (layer.contains("nm") && layer["nm"].is_string() && layer["nm"].get<std::string>() == layerName) {
-                // Check if it's a text layer (ty:5)
-                if (layer.contains("ty") && layer["ty"].is_number() && layer["ty"].get<int>() == 5) {
-                    foundLayer = &layer;
-                    break;
-                }
-            }
-        }
-        
+        // Find the text layer (ty:5) by name (top-level or inside a precomp)
+        nlohmann::json* foundLayer = layers.findTextLayer(layerName);
         if (foundLayer == nullptr) {
             if (g_debug_mode) {
                 LOG_COUT("[DEBUG] Warning: Could not find text layer: " << layerName) << std::endl;
@@ -136,9 +101,6 @@ void modifyTextLayerInJson(
                         // Update font size
                         s["s"] = newSize;
                         
-                        // Serialize back to JSON with 4-space indentation
-                        json = j.dump(4);
-                        
                         if (g_debug_mode) {
                             LOG_COUT("[DEBUG] Text replacement successful for " << layerName << ": \"" << newText << "\"") << std::endl;
                         }
@@ -153,7 +115,7 @@ void modifyTextLayerInJson(
         }
     } catch (const nlohmann::json::exception& e) {
         if (g_debug_mode) {
-            LOG_COUT("[DEBUG] Error parsing JSON in modifyTextLayerInJson: " << e.what()) << std::endl;
+            LOG_COUT("[DEBUG] Error modifying JSON in modifyTextLayerInJson: " << e.what()) << std::endl;
         }
     }
 }
@@ -166,62 +128,12 @@ void normalizeLottieTextNewlines(std::string& json) {
     // We handle both representations:
     // 1) Escaped form inside JSON: "\\u0003"
     // 2) Literal byte form already present in the string: '\x03'
-    
-    try {
-        nlohmann::json j = nlohmann::json::parse(json);
-        bool modified = false;
-        
-        // Recursively find and normalize all "t" string fields in text layers
-        if (j.contains("layers") && j["layers"].is_array()) {
-            for (auto& layer : j["layers"]) {
-                // Check if it's a text layer (ty:5)
-                if (layer.contains("ty") && layer["ty"].is_number() && layer["ty"].get<int>() == 5) {
-                    // Navigate to layers[i]["t"]["d"]["k"][0]["s"]["t"]
-                    if (layer.contains("t") && layer["t"].is_object()) {
-                        auto& t = layer["t"];
-                        if (t.contains("d") && t["d"].is_object()) {
-                            auto& d = t["d"];
-                            if (d.contains("k") && d["k"].is_array() && d["k"].size() > 0) {
-                                auto& k = d["k"];
-                                if (k[0].is_object() && k[0].contains("s") && k[0]["s"].is_object()) {
-                                    auto& s = k[0]["s"];
-                                    if (s.contains("t") && s["t"].is_string()) {
-                                        std::string text = s["t"].get<std::string>();
-                                        std::string originalText = text;
-                                        
-                                        // Replace \u0003 with \r
-                                        replaceAllInPlace(text, "\\u0003", "\\r");
-                                        replaceCharInPlace(text, '\x03', '\r');
-                                        
-                                        if (text != originalText) {
-                                            s["t"] = text;
-                                            modified = true;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        
-        if (modified) {
-            json = j.dump(4);
-        }
-        
-        // Also do global replacement for any remaining escaped sequences
-        const auto replacedEscaped = replaceAllInPlace(json, "\\u0003", "\\r");
-        const auto replacedLiteral = replaceCharInPlace(json, '\x03', '\r');
-        
-        LOG_DEBUG("Text newline normalization: replacedEscaped=\\u0003->\\r x" << replacedEscaped
-                  << ", replacedLiteral=0x03->\\r x" << replacedLiteral);
-    } catch (const nlohmann::json::exception& e) {
-        // Fallback to simple string replacement if JSON parsing fails
-        const auto replacedEscaped = replaceAllInPlace(json, "\\u0003", "\\r");
-        const auto replacedLiteral = replaceCharInPlace(json, '\x03', '\r');
-        
-        LOG_DEBUG("Text newline normalization (fallback): replacedEscaped=\\u0003->\\r x" << replacedEscaped
-                  << ", replacedLiteral=0x03->\\r x" << replacedLiteral);
-    }
+    //
+    // Both are rewritten in place on the serialized text, which covers text layers at any depth
+    // (including precomps) without a parse/serialize round trip.
+    const auto replacedEscaped = replaceAllInPlace(json, "\\u0003", "\\r");
+    const auto replacedLiteral = replaceCharInPlace(json, '\x03', '\r');
+
+    LOG_DEBUG("Text newline normalization: replacedEscaped=\\u0003->\\r x" << replacedEscaped
+              << ", replacedLiteral=0x03->\\r x" << replacedLiteral);
 }
@@ -2,25 +2,29 @@
 #define JSON_MANIPULATION_H
 
 #include <string>
+#include <nlohmann/json.hpp>
+#include "layer_index.h"
+
+// Layer edits operate on a parsed document so callers parse once, apply every override,
+// and serialize once; layers are found through a LayerIndex built once over that document
 
 // Adjust text animator position keyframes based on text width change
 // For right-aligned text, when text is wider, we need to move it further left (more negative X)
 void adjustTextAnimatorPosition(
-    std::string& json,
+    const LayerIndex& layers,
     const std::string& layerName,
     float widthDiff
 );
 
 // Modify JSON to update text layer
 void modifyTextLayerInJson(
-    std::string& json,
+    const LayerIndex& layers,
     const std::string& layerName,
     const std::string& newText,
     float newSize
 );
 
-// Normalize Lottie text newlines
+// Normalize Lottie text newlines (U+0003 soft breaks -> '\r') in serialized JSON, without parsing it
 void normalizeLottieTextNewlines(std::string& json);
 
 #endif // JSON_MANIPULATION_H
-
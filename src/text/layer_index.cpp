@@ -0,0 +1,45 @@
+#include "layer_index.h"
+#include "../utils/logging.h"
+
+LayerIndex::LayerIndex(nlohmann::json& j) {
+    if (!j.is_object()) {
+        return;
+    }
+    if (j.contains("layers") && j["layers"].is_array()) {
+        addLayers(j["layers"], false);
+    }
+    if (j.contains("assets") && j["assets"].is_array()) {
+        for (auto& asset : j["assets"]) {
+            if (asset.is_object() && asset.contains("layers") && asset["layers"].is_array()) {
+                addLayers(asset["layers"], true);
+            }
+        }
+    }
+    LOG_DEBUG("Layer index: " << fLayers.size() << " named layers, " << fTextLayers.size() << " text layers");
+}
+
+void LayerIndex::addLayers(nlohmann::json& layers, bool precomp) {
+    for (auto& layer : layers) {
+        if (!layer.is_object() || !layer.contains("nm") || !layer["nm"].is_string()) {
+            continue;
+        }
+        const std::string& name = layer["nm"].get_ref<const std::string&>();
+        if (!fLayers.emplace(name, &layer).second) {
+            LOG_DEBUG("Layer index: duplicate layer name \"" << name << "\"" << (precomp ? " in a precomp" : "")
+                      << ", overrides apply to the first one");
+        }
+        if (layer.contains("ty") && layer["ty"].is_number() && layer["ty"].get<int>() == 5) {
+            fTextLayers.emplace(name, &layer);
+        }
+    }
+}
+
+nlohmann::json* LayerIndex::findLayer(const std::string& name) const {
+    const auto it = fLayers.find(name);
+    return it != fLayers.end() ? it->second : nullptr;
+}
+
+nlohmann::json* LayerIndex::findTextLayer(const std::string& name) const {
+    const auto it = fTextLayers.find(name);
+    return it != fTextLayers.end() ? it->second : nullptr;
+}
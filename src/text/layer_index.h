@@ -0,0 +1,31 @@
+#ifndef LAYER_INDEX_H
+#define LAYER_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+// Name -> layer lookup over the whole composition: the top-level layers and the layers of every
+// precomp (assets[].layers), built with one pass over a parsed animation
+// Duplicate names resolve to the first layer in document order, top-level layers first and then
+// precomps in assets order (so existing top-level overrides keep their target)
+// The index points into the document: it stays valid while layers are edited in place, but not
+// if layers or assets are added or removed
+class LayerIndex {
+public:
+    explicit LayerIndex(nlohmann::json& j);
+
+    // First layer with this name (any type), nullptr if none
+    nlohmann::json* findLayer(const std::string& name) const;
+
+    // First text layer (ty 5) with this name, nullptr if none
+    nlohmann::json* findTextLayer(const std::string& name) const;
+
+private:
+    void addLayers(nlohmann::json& layers, bool precomp);
+
+    std::unordered_map<std::string, nlohmann::json*> fLayers;
+    std::unordered_map<std::string, nlohmann::json*> fTextLayers;
+};
+
+#endif // LAYER_INDEX_H
@@ -1,14 +1,7 @@
 #include "layer_overrides.h"
+#include "font_service.h"
 #include "../utils/string_utils.h"
 #include "../utils/logging.h"
-#include "include/core/SkFontMgr.h"
-#include "include/core/SkFontStyle.h"
-#include "include/core/SkTypeface.h"
-#include "include/ports/SkFontScanner_FreeType.h"
-#ifndef __EMSCRIPTEN__
-#include "include/ports/SkFontMgr_fontconfig.h"
-#include <fontconfig/fontconfig.h>
-#endif
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <regex>
@@ -140,24 +133,10 @@ bool validateImageLayerConfig(const std::string& assetId, const ImageLayerOverri
 
 bool validateFontExists(const std::string& fontName, const std::string& dataJsonPath, std::string& errorMsg) {
 #ifndef __EMSCRIPTEN__
-    // Check system fonts via fontconfig (not available in WASM)
+    // Check system fonts via the shared fontconfig font manager (not available in WASM)
     try {
-        FcInit();
-        auto scanner = SkFontScanner_Make_FreeType();
-        if (scanner) {
-            auto fontMgr = SkFontMgr_New_FontConfig(nullptr, std::move(scanner));
-            if (fontMgr) {
-                // Try to find font by name
-                auto typeface = fontMgr->matchFamilyStyle(fontName.c_str(), SkFontStyle::Normal());
-                if (typeface) {
-                    return true;  // Found in system fonts
-                }
-                // Try legacy method
-                typeface = fontMgr->legacyMakeTypeface(fontName.c_str(), SkFontStyle::Normal());
-                if (typeface) {
-                    return true;  // Found in system fonts
-                }
-            }
+        if (findTypefaceByName(fontName)) {
+            return true;  // Found in system fonts
         }
     } catch (...) {
         // Fontconfig not available, continue to check fonts directory
@@ -0,0 +1,594 @@
+#include "override_template.h"
+#include "../utils/logging.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace {
+
+// Element of the path to the value being scanned: an object key or an array index
+struct PathElement {
+    std::string_view key;  // Raw key bytes (Lottie keys do not use escapes)
+    int index = -1;
+};
+
+struct ScannedKeyframe {
+    bool object = false;
+    bool s_array = false;
+    size_t s_count = 0;
+    ByteRange x;           // s[0]
+    bool x_number = false;
+};
+
+struct ScannedAnimator {
+    bool object = false;
+    bool a_object = false;
+    bool p_object = false;
+    ByteRange p_a;
+    bool k_array = false;
+    std::vector<ScannedKeyframe> keyframes;
+};
+
+struct ScannedLayer {
+    ByteRange nm;
+    bool nm_string = false;
+    ByteRange ty;
+    bool t_object = false;
+    bool d_object = false;
+    bool dk_array = false;
+    ByteRange k0;          // t.d.k[0]
+    ByteRange style;       // t.d.k[0].s
+    bool style_object = false;
+    ByteRange text;
+    ByteRange size;
+    bool animators_array = false;
+    std::vector<ScannedAnimator> animators;
+};
+
+struct ScannedAsset {
+    ByteRange object;
+    bool is_object = false;
+    ByteRange id;
+    bool id_string = false;
+    ByteRange u;
+    ByteRange p;
+    bool p_string = false;
+};
+
+bool isNumberStart(char c) {
+    return c == '-' || std::isdigit(static_cast<unsigned char>(c));
+}
+
+// Single pass over the JSON that only descends into the containers holding overridable values
+// (text data and animators of top-level and precomp layers, assets) and skips everything else bracket-wise
+class TemplateScanner {
+public:
+    TemplateScanner(const char* json, size_t size) : fBegin(json), fPos(json), fEnd(json + size) {}
+
+    bool scan() {
+        if (!value()) {
+            return false;
+        }
+        skipWhitespace();
+        return fPos == fEnd;
+    }
+
+    ByteRange width;
+    ByteRange fonts;
+    bool assets_array = false;
+    std::vector<ScannedLayer> layers;                       // Top-level layers
+    std::vector<std::vector<ScannedLayer>> precomp_layers;  // assets[i].layers
+    std::vector<ScannedAsset> assets;
+
+private:
+    template <typename T>
+    static T& slot(std::vector<T>& items, int index) {
+        const size_t i = static_cast<size_t>(index);
+        if (items.size() <= i) {
+            items.resize(i + 1);
+        }
+        return items[i];
+    }
+
+    void skipWhitespace() {
+        while (fPos < fEnd && (*fPos == ' ' || *fPos == '\n' || *fPos == '\r' || *fPos == '\t')) {
+            ++fPos;
+        }
+    }
+
+    bool value() {
+        skipWhitespace();
+        if (fPos >= fEnd) {
+            return false;
+        }
+        const size_t start = static_cast<size_t>(fPos - fBegin);
+        const char type = *fPos;
+        bool ok;
+        if (type == '{' || type == '[') {
+            if (wantDescend()) {
+                ok = (type == '{') ? object() : array();
+            } else {
+                ok = skipContainer();
+            }
+        } else if (type == '"') {
+            ok = string();
+        } else {
+            ok = scalar();
+        }
+        if (!ok) {
+            return false;
+        }
+        record({start, static_cast<size_t>(fPos - fBegin)}, type);
+        return true;
+    }
+
+    bool object() {
+        ++fPos;  // '{'
+        skipWhitespace();
+        if (fPos < fEnd && *fPos == '}') {
+            ++fPos;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (fPos >= fEnd || *fPos != '"') {
+                return false;
+            }
+            const char* keyStart = fPos + 1;
+            if (!string()) {
+                return false;
+            }
+            const std::string_view key(keyStart, static_cast<size_t>(fPos - 1 - keyStart));
+            skipWhitespace();
+            if (fPos >= fEnd || *fPos != ':') {
+                return false;
+            }
+            ++fPos;
+            fPath.push_back({key, -1});
+            const bool ok = value();
+            fPath.pop_back();
+            if (!ok) {
+                return false;
+            }
+            skipWhitespace();
+            if (fPos < fEnd && *fPos == ',') {
+                ++fPos;
+            } else if (fPos < fEnd && *fPos == '}') {
+                ++fPos;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    bool array() {
+        ++fPos;  // '['
+        skipWhitespace();
+        if (fPos < fEnd && *fPos == ']') {
+            ++fPos;
+            return true;
+        }
+        for (int index = 0;; ++index) {
+            fPath.push_back({std::string_view(), index});
+            const bool ok = value();
+            fPath.pop_back();
+            if (!ok) {
+                return false;
+            }
+            skipWhitespace();
+            if (fPos < fEnd && *fPos == ',') {
+                ++fPos;
+            } else if (fPos < fEnd && *fPos == ']') {
+                ++fPos;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    bool string() {
+        ++fPos;  // Opening quote
+        while (fPos < fEnd) {
+            const char c = *fPos++;
+            if (c == '\\') {
+                if (fPos >= fEnd) {
+                    return false;
+                }
+                ++fPos;
+            } else if (c == '"') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool scalar() {
+        const char* start = fPos;
+        while (fPos < fEnd && *fPos != ',' && *fPos != '}' && *fPos != ']' &&
+               *fPos != ' ' && *fPos != '\n' && *fPos != '\r' && *fPos != '\t') {
+            ++fPos;
+        }
+        return fPos > start;
+    }
+
+    bool skipContainer() {
+        int depth = 0;
+        while (fPos < fEnd) {
+            const char c = *fPos;
+            if (c == '"') {
+                if (!string()) {
+                    return false;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                --depth;
+            }
+            ++fPos;
+            if (depth == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isKey(size_t i, const char* key) const {
+        return fPath[i].index < 0 && fPath[i].key == key;
+    }
+    bool isIndex(size_t i) const {
+        return fPath[i].index >= 0;
+    }
+
+    // Start of the layer-relative part of the current path: 2 inside layers[i], 4 inside a precomp
+    // layer assets[i].layers[j], 0 outside layers
+    size_t layerPathStart() const {
+        const size_t n = fPath.size();
+        if (n >= 2 && isKey(0, "layers") && isIndex(1)) {
+            return 2;
+        }
+        if (n >= 4 && isKey(0, "assets") && isIndex(1) && isKey(2, "layers") && isIndex(3)) {
+            return 4;
+        }
+        return 0;
+    }
+
+    // Whether to walk into the container at the current path (its ancestors were all walked into,
+    // so only the last element needs checking)
+    bool wantDescend() const {
+        if (fPath.empty()) {
+            return true;
+        }
+        if (fPath.size() == 1) {
+            return isKey(0, "layers") || isKey(0, "assets");
+        }
+        if (isKey(0, "assets") && fPath.size() <= 3) {
+            return fPath.size() == 2 ? isIndex(1) : isKey(2, "layers");
+        }
+        const size_t base = layerPathStart();
+        if (base == 0) {
+            return false;
+        }
+        // Layer-relative path: element b + 2 is the first key inside the layer object
+        const size_t b = base - 2;
+        const size_t n = fPath.size() - b;
+        if (n == 2) return true;
+        if (n == 3) return isKey(b + 2, "t");
+        if (n == 4) return isKey(b + 3, "d") || isKey(b + 3, "a");
+        if (isKey(b + 3, "d")) {
+            // t.d.k[0].s
+            switch (n) {
+                case 5: return isKey(b + 4, "k");
+                case 6: return fPath[b + 5].index == 0;
+                case 7: return isKey(b + 6, "s");
+                default: return false;
+            }
+        }
+        // t.a[i].a.p.k[j].s
+        switch (n) {
+            case 5: return isIndex(b + 4);
+            case 6: return isKey(b + 5, "a");
+            case 7: return isKey(b + 6, "p");
+            case 8: return isKey(b + 7, "k");
+            case 9: return isIndex(b + 8);
+            case 10: return isKey(b + 9, "s");
+            default: return false;
+        }
+    }
+
+    void record(ByteRange range, char type) {
+        const size_t n = fPath.size();
+        if (n == 1) {
+            if (isKey(0, "w")) {
+                width = range;
+            } else if (isKey(0, "fonts")) {
+                fonts = range;
+            } else if (isKey(0, "assets")) {
+                assets_array = (type == '[');
+            }
+            return;
+        }
+        const size_t base = layerPathStart();
+        if (base != 0) {
+            recordLayer(range, type, base);
+        } else if (n >= 2 && isKey(0, "assets") && isIndex(1)) {
+            recordAsset(range, type);
+        }
+    }
+
+    void recordLayer(ByteRange range, char type, size_t base) {
+        ScannedLayer& layer = (base == 2) ? slot(layers, fPath[1].index)
+                                          : slot(slot(precomp_layers, fPath[1].index), fPath[3].index);
+        // Layer-relative path: element b + 2 is the first key inside the layer object
+        const size_t b = base - 2;
+        const size_t n = fPath.size() - b;
+        if (n == 2) {
+            return;
+        }
+        if (n == 3) {
+            if (isKey(b + 2, "nm")) {
+                layer.nm = range;
+                layer.nm_string = (type == '"');
+            } else if (isKey(b + 2, "ty")) {
+                layer.ty = range;
+            } else if (isKey(b + 2, "t")) {
+                layer.t_object = (type == '{');
+            }
+            return;
+        }
+        if (n == 4) {
+            if (isKey(b + 3, "d")) {
+                layer.d_object = (type == '{');
+            } else if (isKey(b + 3, "a")) {
+                layer.animators_array = (type == '[');
+            }
+            return;
+        }
+        if (isKey(b + 3, "d")) {
+            if (n == 5 && isKey(b + 4, "k")) {
+                layer.dk_array = (type == '[');
+            } else if (n == 6 && fPath[b + 5].index == 0) {
+                layer.k0 = range;
+            } else if (n == 7 && isKey(b + 6, "s")) {
+                layer.style = range;
+                layer.style_object = (type == '{');
+            } else if (n == 8 && isKey(b + 7, "t")) {
+                layer.text = range;
+            } else if (n == 8 && isKey(b + 7, "s")) {
+                layer.size = range;
+            }
+            return;
+        }
+        if (!isKey(b + 3, "a") || !isIndex(b + 4)) {
+            return;
+        }
+        ScannedAnimator& animator = slot(layer.animators, fPath[b + 4].index);
+        switch (n) {
+            case 5: animator.object = (type == '{'); return;
+            case 6:
+                if (isKey(b + 5, "a")) {
+                    animator.a_object = (type == '{');
+                }
+                return;
+            case 7:
+                if (isKey(b + 6, "p")) {
+                    animator.p_object = (type == '{');
+                }
+                return;
+            case 8:
+                if (isKey(b + 7, "a") && isNumberStart(type)) {
+                    animator.p_a = range;
+                } else if (isKey(b + 7, "k")) {
+                    animator.k_array = (type == '[');
+                }
+                return;
+            default: break;
+        }
+        if (!isIndex(b + 8)) {
+            return;
+        }
+        ScannedKeyframe& keyframe = slot(animator.keyframes, fPath[b + 8].index);
+        if (n == 9) {
+            keyframe.object = (type == '{');
+        } else if (n == 10 && isKey(b + 9, "s")) {
+            keyframe.s_array = (type == '[');
+        } else if (n == 11) {
+            ++keyframe.s_count;
+            if (fPath[b + 10].index == 0) {
+                keyframe.x = range;
+                keyframe.x_number = isNumberStart(type);
+            }
+        }
+    }
+
+    void recordAsset(ByteRange range, char type) {
+        const size_t n = fPath.size();
+        ScannedAsset& asset = slot(assets, fPath[1].index);
+        if (n == 2) {
+            asset.object = range;
+            asset.is_object = (type == '{');
+        } else if (n == 3 && isKey(2, "id")) {
+            asset.id = range;
+            asset.id_string = (type == '"');
+        } else if (n == 3 && isKey(2, "u")) {
+            asset.u = range;
+        } else if (n == 3 && isKey(2, "p")) {
+            asset.p = range;
+            asset.p_string = (type == '"');
+        }
+    }
+
+    const char* fBegin;
+    const char* fPos;
+    const char* fEnd;
+    std::vector<PathElement> fPath;
+};
+
+nlohmann::json parseRange(const char* json, ByteRange range) {
+    return nlohmann::json::parse(json + range.begin, json + range.end);
+}
+
+// Animated position of a layer, found the way adjustTextAnimatorPosition() finds it
+OverrideTemplate::AnimatorLayer compileAnimatorLayer(const char* json, const ScannedLayer& layer) {
+    OverrideTemplate::AnimatorLayer result;
+    if (!layer.t_object || !layer.animators_array) {
+        return result;
+    }
+    for (const auto& animator : layer.animators) {
+        if (!animator.object || !animator.a_object || !animator.p_object || animator.p_a.empty() ||
+            !animator.k_array) {
+            continue;
+        }
+        if (parseRange(json, animator.p_a).get<int>() != 1) {
+            continue;
+        }
+        result.adjustable = true;
+        for (const auto& keyframe : animator.keyframes) {
+            if (!keyframe.object || !keyframe.s_array || keyframe.s_count < 1) {
+                continue;
+            }
+            if (!keyframe.x_number) {
+                result.exact = false;
+                continue;
+            }
+            result.x.push_back(keyframe.x);
+            result.x_values.push_back(parseRange(json, keyframe.x).get<float>());
+        }
+        break;
+    }
+    return result;
+}
+
+// Record a named layer (later layers with the same name are ignored, as in LayerIndex)
+void compileLayer(const char* json, const ScannedLayer& layer, const nlohmann::json& fonts, OverrideTemplate& tmpl) {
+    if (!layer.nm_string) {
+        return;
+    }
+    const std::string name = parseRange(json, layer.nm).get<std::string>();
+
+    if (tmpl.animator_layers.find(name) == tmpl.animator_layers.end()) {
+        tmpl.animator_layers.emplace(name, compileAnimatorLayer(json, layer));
+    }
+
+    if (layer.ty.empty() || tmpl.text_layers.find(name) != tmpl.text_layers.end()) {
+        return;
+    }
+    const auto ty = parseRange(json, layer.ty);
+    if (!ty.is_number() || ty.get<int>() != 5) {
+        return;
+    }
+
+    OverrideTemplate::TextLayer textLayer;
+    if (layer.t_object && layer.d_object && layer.dk_array && layer.style_object) {
+        textLayer.style = layer.style;
+        textLayer.text = layer.text;
+        textLayer.size = layer.size;
+    }
+
+    // Font info from a document holding just this layer's text document and the font list
+    nlohmann::json textData = nlohmann::json::object();
+    if (layer.t_object) {
+        textData["d"] = nlohmann::json::object();
+        if (layer.d_object) {
+            textData["d"]["k"] = nlohmann::json::array();
+            if (layer.dk_array && !layer.k0.empty()) {
+                textData["d"]["k"].push_back(parseRange(json, layer.k0));
+            }
+        }
+    }
+    nlohmann::json doc = {
+        {"layers", nlohmann::json::array({{{"nm", name}, {"ty", 5}, {"t", textData}}})}
+    };
+    if (!fonts.is_null()) {
+        doc["fonts"] = fonts;
+    }
+    const LayerIndex docLayers(doc);
+    textLayer.font = extractFontInfoFromJson(doc, docLayers, name);
+    tmpl.text_layers.emplace(name, std::move(textLayer));
+}
+
+}  // namespace
+
+bool compileOverrideTemplate(const char* json, size_t size, OverrideTemplate& tmpl) {
+    TemplateScanner scanner(json, size);
+    if (!scanner.scan()) {
+        LOG_DEBUG("Override template: JSON could not be scanned, overrides will use the parsed document");
+        return false;
+    }
+
+    try {
+        if (!scanner.width.empty()) {
+            const auto w = parseRange(json, scanner.width);
+            if (w.is_number()) {
+                tmpl.animation_width = w.get<float>();
+            }
+        }
+        nlohmann::json fonts;
+        if (!scanner.fonts.empty()) {
+            fonts = parseRange(json, scanner.fonts);
+        }
+        tmpl.has_assets = scanner.assets_array;
+
+        // Top-level layers first, then precomps in assets order (LayerIndex order)
+        for (const auto& layer : scanner.layers) {
+            compileLayer(json, layer, fonts, tmpl);
+        }
+        for (const auto& precomp : scanner.precomp_layers) {
+            for (const auto& layer : precomp) {
+                compileLayer(json, layer, fonts, tmpl);
+            }
+        }
+
+        for (const auto& asset : scanner.assets) {
+            if (!asset.is_object || !asset.id_string) {
+                continue;
+            }
+            const std::string id = parseRange(json, asset.id).get<std::string>();
+            if (tmpl.assets.find(id) != tmpl.assets.end()) {
+                continue;
+            }
+            OverrideTemplate::Asset compiled;
+            compiled.object = asset.object;
+            compiled.u = asset.u;
+            compiled.p = asset.p;
+            compiled.has_p_string = asset.p_string;
+            if (asset.p_string) {
+                compiled.p_value = parseRange(json, asset.p).get<std::string>();
+            }
+            tmpl.assets.emplace(id, std::move(compiled));
+        }
+    } catch (const nlohmann::json::exception& e) {
+        LOG_DEBUG("Override template: failed to read a recorded value: " << e.what());
+        return false;
+    }
+
+    LOG_DEBUG("Override template: " << tmpl.text_layers.size() << " text layers, "
+              << tmpl.animator_layers.size() << " named layers, " << tmpl.assets.size() << " assets");
+    return true;
+}
+
+std::string applyJsonSplices(const char* json, size_t size, std::vector<JsonSplice> splices) {
+    std::stable_sort(splices.begin(), splices.end(),
+                     [](const JsonSplice& a, const JsonSplice& b) { return a.begin < b.begin; });
+
+    size_t outputSize = size;
+    for (const auto& splice : splices) {
+        outputSize += splice.replacement.size();
+        outputSize -= splice.end - splice.begin;
+    }
+
+    std::string output;
+    output.reserve(outputSize);
+    size_t cursor = 0;
+    for (const auto& splice : splices) {
+        output.append(json + cursor, splice.begin - cursor);
+        output.append(splice.replacement);
+        cursor = splice.end;
+    }
+    output.append(json + cursor, size - cursor);
+    return output;
+}
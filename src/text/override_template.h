@@ -0,0 +1,74 @@
+#ifndef OVERRIDE_TEMPLATE_H
+#define OVERRIDE_TEMPLATE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "font_utils.h"
+
+// Byte range [begin, end) of a value in the template JSON
+struct ByteRange {
+    size_t begin = 0;
+    size_t end = 0;
+
+    bool empty() const { return end <= begin; }
+};
+
+// Compiled override template: the byte offsets of every value a layer-overrides file can change,
+// recorded with one scan of the (normalized) template JSON. Applying an override set then splices
+// the new values into the template bytes instead of parsing and re-serializing the document.
+// Lookups follow the parsed-document edits (modifyTextLayerInJson, adjustTextAnimatorPosition,
+// image asset overrides), so both paths edit the same layer: layers are found across the
+// top-level layers and every precomp (assets[].layers) with the LayerIndex duplicate-name policy
+// (first in document order, top-level layers first, then precomps in assets order), and the
+// first asset with a given id wins.
+struct OverrideTemplate {
+    // First text layer (ty 5) with a given name
+    struct TextLayer {
+        FontInfo font;            // As extractFontInfoFromJson() returns it
+        ByteRange style;          // t.d.k[0].s object (empty if the layer has no text style object)
+        ByteRange text;           // t.d.k[0].s.t value (empty if missing)
+        ByteRange size;           // t.d.k[0].s.s value (empty if missing)
+    };
+
+    // Animated text animator position of the first layer with a given name
+    struct AnimatorLayer {
+        bool adjustable = false;           // The layer has an animated position (p.a == 1 with keyframes)
+        bool exact = true;                 // false: a keyframe X is not a number (edit needs the document)
+        std::vector<ByteRange> x;          // k[i].s[0] of every keyframe
+        std::vector<float> x_values;
+    };
+
+    // First image asset with a given id
+    struct Asset {
+        ByteRange object;         // The asset object
+        ByteRange u;              // "u" value (empty if missing)
+        ByteRange p;              // "p" value (empty if missing)
+        bool has_p_string = false;
+        std::string p_value;
+    };
+
+    float animation_width = 720.0f;   // "w" (720 when missing, as in processLayerOverrides)
+    bool has_assets = false;          // Top-level "assets" is an array
+    std::map<std::string, TextLayer> text_layers;
+    std::map<std::string, AnimatorLayer> animator_layers;
+    std::map<std::string, Asset> assets;
+};
+
+// Scan the JSON once and record the override offsets
+// Returns false if the JSON is malformed (callers then use the parsed-document path)
+bool compileOverrideTemplate(const char* json, size_t size, OverrideTemplate& tmpl);
+
+// Replacement of the bytes [begin, end) of the template (begin == end inserts)
+struct JsonSplice {
+    size_t begin;
+    size_t end;
+    std::string replacement;
+};
+
+// Build the JSON with the splices applied (splices must not overlap; insertions at the same
+// offset keep their order)
+std::string applyJsonSplices(const char* json, size_t size, std::vector<JsonSplice> splices);
+
+#endif // OVERRIDE_TEMPLATE_H
@@ -0,0 +1,297 @@
+#include "text_fit_cache.h"
+#include "font_service.h"
+#include "../utils/logging.h"
+#include "../utils/sha256.h"
+#include "../utils/version.h"
+#include "include/core/SkStream.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Bump when the entry layout, key composition or fitting algorithm changes
+static const char* kTextFitCacheFormat = "text-fit-v2";
+static const char* kUsageFileName = "usage";
+static const char* kTempMarker = ".tmp-";
+
+// Eviction goes below the limit so that it does not run again on the next few stores
+static constexpr uint64_t kEvictTargetBytes = TextFitCache::kMaxBytes / 4 * 3;
+
+// Temp files older than this are leftovers of crashed processes
+static const auto kStaleAge = std::chrono::hours(1);
+
+static std::unique_ptr<TextFitCache> g_textFitCache;
+
+// Exact float value for keys (decimal formatting would merge nearby values)
+static std::string floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char hex[9];
+    snprintf(hex, sizeof(hex), "%08x", bits);
+    return hex;
+}
+
+// Disk space a file or directory occupies (allocated blocks, not its length)
+static uint64_t allocatedBytes(const fs::path& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(st.st_blocks) * 512;
+}
+
+TextFitCache::TextFitCache(const std::string& root)
+    : fRoot(root) {
+    std::error_code ec;
+    fs::create_directories(fRoot, ec);
+    fValid = !ec && fs::is_directory(fRoot, ec);
+    if (!fValid) {
+        LOG_CERR("[WARNING] Text-fit cache directory is not usable, text fits are not cached: " << fRoot) << std::endl;
+    }
+}
+
+std::string TextFitCache::entryPath(const std::string& key) const {
+    return (fs::path(fRoot) / key.substr(0, 2) / key).string();
+}
+
+std::string TextFitCache::fontHash(const sk_sp<SkTypeface>& typeface) {
+    std::lock_guard<std::mutex> lock(fFontHashMutex);
+    auto it = fFontHashes.find(typeface->uniqueID());
+    if (it != fFontHashes.end()) {
+        return it->second;
+    }
+
+    std::string hash;
+    int ttcIndex = 0;
+    std::unique_ptr<SkStreamAsset> stream = typeface->openStream(&ttcIndex);
+    if (stream) {
+        Sha256 hasher;
+        std::vector<char> buffer(64 * 1024);
+        size_t bytesRead;
+        while ((bytesRead = stream->read(buffer.data(), buffer.size())) > 0) {
+            hasher.update(buffer.data(), bytesRead);
+        }
+        hash = hasher.hexDigest() + ":" + std::to_string(ttcIndex);
+    } else {
+        LOG_DEBUG("[CACHE] Font data not readable, text fits with it are not cached");
+    }
+    fFontHashes.emplace(typeface->uniqueID(), hash);
+    return hash;
+}
+
+std::string TextFitCache::key(
+    SkFontMgr* fontMgr,
+    const FontInfo& fontInfo,
+    const LayerOverride& config,
+    const std::string& text,
+    float paddedTargetWidth,
+    TextMeasurementMode mode
+) {
+    sk_sp<SkTypeface> typeface = resolveTypeface(fontMgr, fontInfo.family, fontInfo.style, fontInfo.name);
+    if (!typeface) {
+        return "";
+    }
+    std::string font = fontHash(typeface);
+    if (font.empty()) {
+        return "";
+    }
+
+    Sha256 hasher;
+    hasher.update(std::string(kTextFitCacheFormat) +
+                  "|version=" + getLotioVersion() +
+                  "|font=" + font +
+                  "|size=" + floatBits(fontInfo.size) +
+                  "|target=" + floatBits(paddedTargetWidth) +
+                  "|min=" + floatBits(config.minSize) +
+                  "|max=" + floatBits(config.maxSize) +
+                  "|mode=" + std::to_string(static_cast<int>(mode)));
+    // Length-prefixed so the text and fallback text cannot run into each other
+    hasher.update("|text=" + std::to_string(text.size()) + ":");
+    hasher.update(text);
+    hasher.update("|fallback=" + std::to_string(config.fallbackText.size()) + ":");
+    hasher.update(config.fallbackText);
+    return hasher.hexDigest();
+}
+
+bool TextFitCache::lookup(const std::string& key, TextFit& fit) const {
+    if (!fValid) {
+        return false;
+    }
+    const std::string path = entryPath(key);
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    try {
+        nlohmann::json j = nlohmann::json::parse(file);
+        fit.text = j.at("text").get<std::string>();
+        fit.size = j.at("size").get<float>();
+        fit.originalWidth = j.at("originalWidth").get<float>();
+        fit.newWidth = j.at("newWidth").get<float>();
+    } catch (const nlohmann::json::exception& e) {
+        LOG_DEBUG("[CACHE] Unreadable text fit entry " << key << ": " << e.what());
+        return false;
+    }
+    // Refresh mtime: it is the LRU timestamp used by evict()
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void TextFitCache::store(const std::string& key, const TextFit& fit) {
+    if (!fValid) {
+        return;
+    }
+    const fs::path path = entryPath(key);
+    uint64_t bytes = 0;
+    std::error_code ec;
+    if (fs::create_directory(path.parent_path(), ec)) {
+        bytes += allocatedBytes(path.parent_path());
+    } else if (ec) {
+        return;
+    }
+
+    static std::atomic<uint64_t> counter(0);
+    fs::path tempPath = path;
+    tempPath += std::string(kTempMarker) + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    nlohmann::json j = {
+        {"text", fit.text},
+        {"size", fit.size},
+        {"originalWidth", fit.originalWidth},
+        {"newWidth", fit.newWidth}
+    };
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file << j.dump();
+        if (!file) {
+            file.close();
+            fs::remove(tempPath, ec);
+            return;
+        }
+    }
+    // Readers see either no entry or a complete one; a concurrent store of the same fit just replaces it
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return;
+    }
+    bytes += allocatedBytes(path);
+    fStoredBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void TextFitCache::flush() {
+    const uint64_t stored = fStoredBytes.exchange(0);
+    if (!fValid || stored == 0) {
+        return;
+    }
+    const std::string usagePath = (fs::path(fRoot) / kUsageFileName).string();
+    int fd = open(usagePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    // One process updates the usage (and evicts) at a time
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return;
+    }
+    char buffer[32] = {};
+    ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    uint64_t usage = (length > 0) ? std::strtoull(buffer, nullptr, 10) : 0;
+    // Re-stores of existing fits are counted again; the overestimate only brings eviction forward,
+    // and eviction recounts the exact size
+    usage += stored;
+    if (usage > kMaxBytes) {
+        usage = evict();
+    }
+    const std::string value = std::to_string(usage);
+    if (ftruncate(fd, 0) != 0 || pwrite(fd, value.data(), value.size(), 0) != static_cast<ssize_t>(value.size())) {
+        LOG_DEBUG("[CACHE] Could not update text-fit cache usage: " << usagePath);
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+uint64_t TextFitCache::evict() const {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type mtime;
+        uint64_t bytes;
+    };
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    const auto now = fs::file_time_type::clock::now();
+
+    std::error_code ec;
+    for (const auto& shard : fs::directory_iterator(fRoot, ec)) {
+        std::error_code itemEc;
+        const std::string shardName = shard.path().filename().string();
+        if (shardName == kUsageFileName) {
+            continue;
+        }
+        if (shardName.size() != 2 || !shard.is_directory(itemEc)) {
+            fs::remove_all(shard.path(), itemEc);  // Entry of an older cache layout
+            continue;
+        }
+        totalBytes += allocatedBytes(shard.path());
+        for (const auto& file : fs::directory_iterator(shard.path(), itemEc)) {
+            std::error_code fileEc;
+            auto mtime = fs::last_write_time(file.path(), fileEc);
+            if (fileEc) {
+                continue;  // Evicted by another process meanwhile
+            }
+            if (file.path().filename().string().find(kTempMarker) != std::string::npos) {
+                if (now - mtime > kStaleAge) {
+                    fs::remove(file.path(), fileEc);
+                }
+                continue;
+            }
+            uint64_t bytes = allocatedBytes(file.path());
+            entries.push_back({file.path(), mtime, bytes});
+            totalBytes += bytes;
+        }
+    }
+
+    // Oldest first
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.mtime < b.mtime;
+    });
+    size_t evicted = 0;
+    for (const auto& entry : entries) {
+        if (totalBytes <= kEvictTargetBytes) {
+            break;
+        }
+        std::error_code removeEc;
+        if (fs::remove(entry.path, removeEc)) {
+            totalBytes -= entry.bytes;
+            evicted++;
+        }
+    }
+    LOG_DEBUG("[CACHE] Evicted " << evicted << " text fits, " << totalBytes << " bytes allocated");
+    return totalBytes;
+}
+
+bool useTextFitCache(const std::string& cacheDir) {
+    auto cache = std::make_unique<TextFitCache>((fs::path(cacheDir) / TextFitCache::kDirectoryName).string());
+    if (!cache->valid()) {
+        return false;
+    }
+    g_textFitCache = std::move(cache);
+    return true;
+}
+
+TextFitCache* sharedTextFitCache() {
+    return g_textFitCache.get();
+}
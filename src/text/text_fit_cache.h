@@ -0,0 +1,78 @@
+#ifndef TEXT_FIT_CACHE_H
+#define TEXT_FIT_CACHE_H
+
+#include "font_utils.h"
+#include "layer_overrides.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkTypeface.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Fit of one overridden text layer: the text used (value or fallback), its size, and the text
+// widths before and after (for the animator position adjustment)
+struct TextFit {
+    std::string text;
+    float size = 0.0f;
+    float originalWidth = 0.0f;
+    float newWidth = 0.0f;
+};
+
+// Persistent text-fit cache shared between lotio processes
+// Keyed by the SHA-256 of the resolved font file, the text and fallback text, the original font
+// size, the padded target width, min/max size, the measurement mode and the lotio version, so a
+// hit is exactly the fit the measurement would produce. Each fit is one small file,
+// <root>/<first two key digits>/<key>, published with an atomic rename. The allocated size of
+// the stored fits is tracked in <root>/usage (updated under a file lock once per text stage,
+// flush()); the least recently used fits are evicted only when it exceeds kMaxBytes.
+class TextFitCache {
+public:
+    static constexpr const char* kDirectoryName = "_textfit";  // Inside the render cache root
+    static constexpr uint64_t kMaxBytes = 8 * 1024 * 1024;
+
+    explicit TextFitCache(const std::string& root);
+
+    bool valid() const { return fValid; }
+
+    // Cache key of a fit; "" if the font data cannot be read (the fit is then not cached)
+    std::string key(
+        SkFontMgr* fontMgr,
+        const FontInfo& fontInfo,
+        const LayerOverride& config,
+        const std::string& text,
+        float paddedTargetWidth,
+        TextMeasurementMode mode
+    );
+
+    bool lookup(const std::string& key, TextFit& fit) const;
+    void store(const std::string& key, const TextFit& fit);
+
+    // Add the fits stored since the last flush to the tracked size; evict if it is over the limit
+    void flush();
+
+private:
+    // SHA-256 of the typeface's font file and collection index, memoized per typeface
+    std::string fontHash(const sk_sp<SkTypeface>& typeface);
+
+    std::string entryPath(const std::string& key) const;
+
+    // Remove least recently used fits down to kEvictTargetBytes; returns the allocated size left
+    uint64_t evict() const;
+
+    std::string fRoot;
+    bool fValid = false;
+    std::mutex fFontHashMutex;
+    std::map<SkTypefaceID, std::string> fFontHashes;  // Empty entries record unreadable fonts
+    std::atomic<uint64_t> fStoredBytes{0};            // Allocated by fits stored since the last flush
+};
+
+// Enable the text-fit cache in <cacheDir>/_textfit for this process (--cache-dir)
+// Returns false if the directory is not usable
+bool useTextFitCache(const std::string& cacheDir);
+
+// The process's text-fit cache, nullptr if not enabled
+TextFitCache* sharedTextFitCache();
+
+#endif // TEXT_FIT_CACHE_H
@@ -1,36 +1,39 @@
 #include "text_processor.h"
 #include "layer_overrides.h"
 #include "font_utils.h"
+#include "font_service.h"
+#include "glyph_run_cache.h"
 #include "text_sizing.h"
+#include "text_fit_cache.h"
 #include "json_manipulation.h"
+#include "override_template.h"
 #include "../utils/logging.h"
 #include "include/core/SkFontMgr.h"
-#include "include/ports/SkFontScanner_FreeType.h"
-#ifndef __EMSCRIPTEN__
-#include "include/ports/SkFontMgr_fontconfig.h"
-#include <fontconfig/fontconfig.h>
-#endif
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
 #include <vector>
 #include <filesystem>
 
-std::string processLayerOverrides(
-    std::string& json_data,
+// Read the overrides file; returns false if it has no image or text layer overrides
+static bool loadLayerOverrides(
     const std::string& layer_overrides_file,
     float textPadding,
-    TextMeasurementMode textMeasurementMode
+    TextMeasurementMode textMeasurementMode,
+    std::map<std::string, LayerOverride>& layerOverrides,
+    std::map<std::string, ImageLayerOverride>& imageLayers
 ) {
-    if (layer_overrides_file.empty()) {
-        return json_data;  // No processing needed
-    }
-    
     const char* modeStr = (textMeasurementMode == TextMeasurementMode::FAST) ? "FAST" :
-                         (textMeasurementMode == TextMeasurementMode::ACCURATE) ? "ACCURATE" : "PIXEL_PERFECT";
+                         (textMeasurementMode == TextMeasurementMode::ACCURATE) ? "ACCURATE" :
+                         (textMeasurementMode == TextMeasurementMode::HYBRID) ? "HYBRID" : "PIXEL_PERFECT";
     LOG_DEBUG("Loading layer overrides from: " << layer_overrides_file);
     LOG_DEBUG("Text measurement mode: " << modeStr);
     LOG_DEBUG("Text padding: " << textPadding << " (" << (textPadding * 100.0f) << "% of target width)");
-    auto layerOverrides = parseLayerOverrides(layer_overrides_file);
-    auto imageLayers = parseImageLayers(layer_overrides_file);
+    layerOverrides = parseLayerOverrides(layer_overrides_file);
+    imageLayers = parseImageLayers(layer_overrides_file);
     
     // Get the layer-overrides file's parent directory for resolving relative image paths
     std::filesystem::path overridesPath(layer_overrides_file);
@@ -41,14 +44,355 @@ std::string processLayerOverrides(
     std::filesystem::path absOverridesBaseDir = std::filesystem::absolute(overridesBaseDir, ec);
     const std::string overridesBaseDirStr = (ec ? overridesBaseDir.string() : absOverridesBaseDir.string());
     LOG_DEBUG("Layer-overrides base directory for relative image paths: " << overridesBaseDirStr);
+
+    if (imageLayers.empty() && layerOverrides.empty()) {
+        LOG_DEBUG("No image or text layer overrides found in config file");
+        return false;
+    }
+    return true;
+}
+
+// Resolve the new u (directory) and p (file name) of an image asset override
+// assetFileName: the asset's current "p" (nullptr if it has none)
+// Returns false if the override cannot be applied
+static bool resolveImageOverridePath(
+    const std::string& assetId,
+    const ImageLayerOverride& imageConfig,
+    const std::string* assetFileName,
+    std::string& dir,
+    std::string& filename
+) {
+    // Determine the full path from filePath and fileName
+    if (imageConfig.filePath.empty() && !imageConfig.fileName.empty()) {
+        // filePath is empty string, fileName contains full path
+        std::filesystem::path fullPathObj(imageConfig.fileName);
+        if (fullPathObj.is_absolute()) {
+            dir = fullPathObj.parent_path().string();
+            filename = fullPathObj.filename().string();
+        } else {
+            // Relative path - keep it relative, split into dir and filename
+            size_t lastSlash = imageConfig.fileName.find_last_of("/\\");
+            dir = (lastSlash != std::string::npos) ? imageConfig.fileName.substr(0, lastSlash + 1) : "";
+            filename = (lastSlash != std::string::npos) ? imageConfig.fileName.substr(lastSlash + 1) : imageConfig.fileName;
+        }
+    } else if (!imageConfig.filePath.empty() && !imageConfig.fileName.empty()) {
+        // Both specified, combine them
+        std::filesystem::path pathObj(imageConfig.filePath);
+        if (pathObj.is_absolute()) {
+            // Absolute path - use as-is
+            dir = imageConfig.filePath;
+            if (dir.back() != '/' && dir.back() != '\\') {
+                dir += "/";
+            }
+            filename = imageConfig.fileName;
+        } else {
+            // Relative path - keep it relative (don't convert to absolute)
+            // Skia will resolve it relative to the animation file's directory
+            dir = imageConfig.filePath;
+            if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
+                dir += "/";
+            }
+            filename = imageConfig.fileName;
+        }
+    } else if (!imageConfig.filePath.empty() && imageConfig.fileName.empty()) {
+        // Only filePath specified - use default fileName from assets[].p
+        dir = imageConfig.filePath;
+        if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
+            dir += "/";
+        }
+        // Extract filename from assets[].p
+        if (assetFileName != nullptr) {
+            filename = *assetFileName;
+            LOG_DEBUG("Using default fileName from assets[].p: " << filename);
+        } else {
+            LOG_CERR("[WARNING] Could not find \"p\" property for asset ID: " << assetId << ", skipping") << std::endl;
+            return false;
+        }
+    } else {
+        // Both empty - skip (shouldn't happen due to validation)
+        LOG_CERR("[WARNING] Both filePath and fileName are empty for asset ID: " << assetId) << std::endl;
+        return false;
+    }
+
+    // Normalize directory path (ensure it ends with / for relative paths)
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
+        dir += "/";
+    }
+    if (dir == "/" || dir == "\\") {
+        dir = "";  // Root path means empty directory
+    }
+
+    return true;
+}
+
+// New text and size of one overridden text layer
+struct LayerModification {
+    std::string layerName;
+    std::string textToUse;
+    float optimalSize;
+    float originalTextWidth;  // Original text width at original size
+    float newTextWidth;       // New text width at optimal size
+};
+
+// Animator position adjustment for a modification (0 = leave the keyframes as they are)
+static float animatorAdjustment(const LayerModification& modification) {
+    float widthDiff = modification.newTextWidth - modification.originalTextWidth;
+    if (std::abs(widthDiff) > 0.1f) {  // Only adjust if there's a significant change
+        // Always move further left by the absolute difference to ensure text stays off-screen
+        return std::abs(widthDiff);
+    }
+    return 0.0f;
+}
+
+// Calculate the optimal size of one overridden text layer
+// Only reads its arguments, so layers can be fitted concurrently
+// Returns false if the layer is skipped (no font info or no text)
+static bool computeLayerModification(
+    const std::string& layerName,
+    const LayerOverride& config,
+    const FontInfo& fontInfo,
+    float animationWidth,
+    float textPadding,
+    TextMeasurementMode textMeasurementMode,
+    SkFontMgr* fontMgr,
+    LayerModification& modification
+) {
+    LOG_DEBUG("Processing text layer: " << layerName);
+
+    if (fontInfo.name.empty()) {
+        LOG_DEBUG("Warning: Could not find font info for layer " << layerName);
+        return false;
+    }
+
+    // Determine text to use
+    std::string textToUse = config.value.empty() ? fontInfo.text : config.value;
+
+    if (textToUse.empty()) {
+        LOG_DEBUG("Warning: No text value for layer " << layerName);
+        return false;
+    }
+
+    // Determine target width (priority: config override > JSON sz > animation width)
+    float targetWidth = animationWidth;
+    if (config.textBoxWidth > 0) {
+        targetWidth = config.textBoxWidth;
+    } else if (fontInfo.textBoxWidth > 0) {
+        targetWidth = fontInfo.textBoxWidth;
+    }
+
+    // Repeated fits come from the persistent text-fit cache (--cache-dir)
+    TextFitCache* fitCache = sharedTextFitCache();
+    std::string fitKey;
+    if (fitCache) {
+        fitKey = fitCache->key(fontMgr, fontInfo, config, textToUse, targetWidth * textPadding, textMeasurementMode);
+        TextFit fit;
+        if (!fitKey.empty() && fitCache->lookup(fitKey, fit)) {
+            LOG_DEBUG("  Cached fit: \"" << fit.text << "\" at size " << fit.size);
+            modification = {layerName, fit.text, fit.size, fit.originalWidth, fit.newWidth};
+            return true;
+        }
+    }
+
+    // Debug: measure current text at original size
+    float currentWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
+                                         fontInfo.name, fontInfo.size, textToUse, textMeasurementMode);
+    LOG_DEBUG("  Original text: \"" << textToUse << "\"");
+    LOG_DEBUG("  Original size: " << fontInfo.size << ", measured width: " << currentWidth);
+    if (config.textBoxWidth > 0) {
+        LOG_DEBUG("  Text box width (from config override): " << config.textBoxWidth);
+    } else if (fontInfo.textBoxWidth > 0) {
+        LOG_DEBUG("  Text box width (from sz): " << fontInfo.textBoxWidth);
+    } else {
+        LOG_DEBUG("  Text box width: not found, using animation width");
+    }
+    LOG_DEBUG("  Target width: " << targetWidth);
+    LOG_DEBUG("  Min size: " << config.minSize << ", Max size: " << config.maxSize);
+
+    // If minSize and maxSize are not specified, no auto-fit - just use original size or update text value
+    float optimalSize = fontInfo.size;
+    float finalWidth = 0.0f;
+
+    if (config.minSize > 0 && config.maxSize > 0) {
+        // Apply padding to target width to prevent text from touching edges
+        // textPadding: 0.97 means 97% of target width (3% padding, 1.5% per side)
+        float paddedTargetWidth = targetWidth * textPadding;
+        LOG_DEBUG("  Padded target width: " << paddedTargetWidth << " (" << (textPadding * 100.0f) << "% of " << targetWidth << ")");
+
+        // Calculate optimal font size
+        optimalSize = calculateOptimalFontSize(
+            fontMgr,
+            fontInfo,
+            config,
+            textToUse,
+            paddedTargetWidth,
+            textMeasurementMode
+        );
+
+        if (optimalSize >= 0) {
+            finalWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
+                                         fontInfo.name, optimalSize, textToUse, textMeasurementMode);
+            LOG_DEBUG("  Optimal size: " << optimalSize << ", final width: " << finalWidth);
+        }
+
+        if (optimalSize < 0) {
+        // Text doesn't fit even at min size, use fallback
+        float minWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
+                                         fontInfo.name, config.minSize, textToUse, textMeasurementMode);
+        LOG_DEBUG("Text doesn't fit at min size for " << layerName << ":");
+        LOG_DEBUG("  Text length: " << textToUse.length() << " characters");
+        LOG_DEBUG("  Text content: \"" << textToUse << "\"");
+        LOG_DEBUG("  Measured width at min size (" << config.minSize << "): " << minWidth);
+        LOG_DEBUG("  Using fallback text: \"" << config.fallbackText << "\"");
+        textToUse = config.fallbackText;
+
+        // Create a temporary fontInfo with minSize as the starting size
+        FontInfo fallbackFontInfo = fontInfo;
+        fallbackFontInfo.size = config.minSize;
+
+        // Measure fallback text at min size
+        float fallbackMinWidth = measureTextWidth(fontMgr, fallbackFontInfo.family, 
+                                                 fallbackFontInfo.style, fallbackFontInfo.name, 
+                                                 config.minSize, textToUse, textMeasurementMode);
+
+        if (fallbackMinWidth > paddedTargetWidth) {
+            // Fallback doesn't fit even at min size, use min size anyway (will overflow)
+            LOG_DEBUG("  Fallback text doesn't fit at min size (" << fallbackMinWidth << " > " << paddedTargetWidth << "), using min size (will overflow)");
+            optimalSize = config.minSize;
+            finalWidth = measureTextWidth(fontMgr, fallbackFontInfo.family,
+                                         fallbackFontInfo.style, fallbackFontInfo.name,
+                                         config.minSize, textToUse, textMeasurementMode);
+        } else {
+            // Fallback fits at min size, try to maximize up to maxSize
+            optimalSize = fitFontSizeFromMinimum(fontMgr, fallbackFontInfo, config, textToUse,
+                                                 paddedTargetWidth, fallbackMinWidth, textMeasurementMode);
+            finalWidth = measureTextWidth(fontMgr, fallbackFontInfo.family,
+                                         fallbackFontInfo.style, fallbackFontInfo.name,
+                                         optimalSize, textToUse, textMeasurementMode);
+            LOG_DEBUG("  Fallback text optimal size: " << optimalSize << " (width: " << finalWidth << " / " << paddedTargetWidth << ")");
+        }
+        }
+    } else {
+        // No auto-fit, just measure at original size
+        finalWidth = currentWidth;
+        optimalSize = fontInfo.size;
+        LOG_DEBUG("  No auto-fit (minSize/maxSize not specified), using original size: " << optimalSize);
+    }
+
+    // Store original and new text widths for position adjustment
+    float originalTextWidth = currentWidth;
+    float newTextWidth = finalWidth;
+
+    if (!fitKey.empty()) {
+        fitCache->store(fitKey, {textToUse, optimalSize, originalTextWidth, newTextWidth});
+    }
+
+    modification = {layerName, textToUse, optimalSize, originalTextWidth, newTextWidth};
+    return true;
+}
+
+// Extract font info and calculate the optimal size of every overridden text layer
+// Font info is read sequentially (it walks the document); the size searches, which dominate with
+// many text fields, run on one thread per core. The result keeps layerOverrides order, so it is
+// the same as fitting the layers one after another.
+static std::vector<LayerModification> computeTextModifications(
+    const std::map<std::string, LayerOverride>& layerOverrides,
+    const std::function<FontInfo(const std::string&)>& fontInfoForLayer,
+    float animationWidth,
+    float textPadding,
+    TextMeasurementMode textMeasurementMode,
+    SkFontMgr* fontMgr
+) {
+    LOG_DEBUG("Found " << layerOverrides.size() << " text layer overrides");
+    
+    // Font manager for text measurement (the caller's when provided, otherwise the shared one)
+    sk_sp<SkFontMgr> tempFontMgr = fontMgr ? sk_ref_sp(fontMgr) : sharedFontManager();
+    
+    std::vector<const std::pair<const std::string, LayerOverride>*> layers;
+    std::vector<FontInfo> fontInfos;
+    layers.reserve(layerOverrides.size());
+    fontInfos.reserve(layerOverrides.size());
+    for (const auto& entry : layerOverrides) {
+        layers.push_back(&entry);
+        fontInfos.push_back(fontInfoForLayer(entry.first));
+    }
+    
+    int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (hardware_threads <= 0) {
+        hardware_threads = 4;
+    }
+    const int num_threads = std::min(hardware_threads, static_cast<int>(layers.size()));
+    LOG_DEBUG("Fitting " << layers.size() << " text layers on " << num_threads << " threads");
+    
+    // Each slot is written by exactly one worker; results are collected in order after all joined
+    std::vector<LayerModification> fitted(layers.size());
+    std::vector<char> applies(layers.size(), 0);
+    std::atomic<size_t> next_layer{0};
+    auto fit_worker = [&]() {
+        for (size_t i = next_layer++; i < layers.size(); i = next_layer++) {
+            applies[i] = computeLayerModification(layers[i]->first, layers[i]->second, fontInfos[i],
+                                                  animationWidth, textPadding, textMeasurementMode,
+                                                  tempFontMgr.get(), fitted[i]);
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (int t = 1; t < num_threads; t++) {
+        workers.emplace_back(fit_worker);
+    }
+    fit_worker();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (TextFitCache* fitCache = sharedTextFitCache()) {
+        fitCache->flush();
+    }
+    if (tempFontMgr.get() == sharedTypefaceResolver().fontManager()) {
+        const auto& resolver = sharedTypefaceResolver();
+        LOG_DEBUG("Typeface resolutions so far: " << resolver.hits() << " cached, " << resolver.misses() << " matched");
+    }
+    const auto& glyphRuns = sharedGlyphRunCache();
+    LOG_DEBUG("Glyph mappings so far: " << glyphRuns.hits() << " cached, " << glyphRuns.misses() << " mapped");
+    
+    std::vector<LayerModification> modifications;
+    for (size_t i = 0; i < layers.size(); i++) {
+        if (applies[i]) {
+            modifications.push_back(std::move(fitted[i]));
+        }
+    }
+    return modifications;
+}
+
+std::string processLayerOverrides(
+    std::string& json_data,
+    const std::string& layer_overrides_file,
+    float textPadding,
+    TextMeasurementMode textMeasurementMode,
+    SkFontMgr* fontMgr
+) {
+    if (layer_overrides_file.empty()) {
+        return json_data;  // No processing needed
+    }
+    
+    std::map<std::string, LayerOverride> layerOverrides;
+    std::map<std::string, ImageLayerOverride> imageLayers;
+    if (!loadLayerOverrides(layer_overrides_file, textPadding, textMeasurementMode, layerOverrides, imageLayers)) {
+        return json_data;
+    }
+
+    // Parse the animation once; every override edits this document and it is serialized once at the end
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(json_data);
+    } catch (const nlohmann::json::exception& e) {
+        LOG_CERR("[ERROR] Failed to parse JSON for layer overrides: " << e.what()) << std::endl;
+        return json_data;
+    }
     
     // Process image layer overrides first (before text processing)
     if (!imageLayers.empty()) {
         LOG_DEBUG("Found " << imageLayers.size() << " image layer overrides");
         
         try {
-            nlohmann::json j = nlohmann::json::parse(json_data);
-            
             if (j.contains("assets") && j["assets"].is_array()) {
                 // Process each asset
                 for (const auto& [assetId, imageConfig] : imageLayers) {
@@ -68,69 +412,18 @@ std::string processLayerOverrides(
                         continue;
                     }
                     
-                    // Determine the full path from filePath and fileName
+                    std::string assetFileName;
+                    const bool hasFileName = (*foundAsset).contains("p") && (*foundAsset)["p"].is_string();
+                    if (hasFileName) {
+                        assetFileName = (*foundAsset)["p"].get<std::string>();
+                    }
                     std::string dir;
                     std::string filename;
-                    
-                    if (imageConfig.filePath.empty() && !imageConfig.fileName.empty()) {
-                        // filePath is empty string, fileName contains full path
-                        std::filesystem::path fullPathObj(imageConfig.fileName);
-                        if (fullPathObj.is_absolute()) {
-                            dir = fullPathObj.parent_path().string();
-                            filename = fullPathObj.filename().string();
-                        } else {
-                            // Relative path - keep it relative, split into dir and filename
-                            size_t lastSlash = imageConfig.fileName.find_last_of("/\\");
-                            dir = (lastSlash != std::string::npos) ? imageConfig.fileName.substr(0, lastSlash + 1) : "";
-                            filename = (lastSlash != std::string::npos) ? imageConfig.fileName.substr(lastSlash + 1) : imageConfig.fileName;
-                        }
-                    } else if (!imageConfig.filePath.empty() && !imageConfig.fileName.empty()) {
-                        // Both specified, combine them
-                        std::filesystem::path pathObj(imageConfig.filePath);
-                        if (pathObj.is_absolute()) {
-                            // Absolute path - use as-is
-                            dir = imageConfig.filePath;
-                            if (dir.back() != '/' && dir.back() != '\\') {
-                                dir += "/";
-                            }
-                            filename = imageConfig.fileName;
-                        } else {
-                            // Relative path - keep it relative (don't convert to absolute)
-                            // Skia will resolve it relative to the animation file's directory
-                            dir = imageConfig.filePath;
-                            if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
-                                dir += "/";
-                            }
-                            filename = imageConfig.fileName;
-                        }
-                    } else if (!imageConfig.filePath.empty() && imageConfig.fileName.empty()) {
-                        // Only filePath specified - use default fileName from assets[].p
-                        dir = imageConfig.filePath;
-                        if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
-                            dir += "/";
-                        }
-                        // Extract filename from assets[].p
-                        if ((*foundAsset).contains("p") && (*foundAsset)["p"].is_string()) {
-                            filename = (*foundAsset)["p"].get<std::string>();
-                            LOG_DEBUG("Using default fileName from assets[].p: " << filename);
-                        } else {
-                            LOG_CERR("[WARNING] Could not find \"p\" property for asset ID: " << assetId << ", skipping") << std::endl;
-                            continue;
-                        }
-                    } else {
-                        // Both empty - skip (shouldn't happen due to validation)
-                        LOG_CERR("[WARNING] Both filePath and fileName are empty for asset ID: " << assetId) << std::endl;
+                    if (!resolveImageOverridePath(assetId, imageConfig, hasFileName ? &assetFileName : nullptr,
+                                                  dir, filename)) {
                         continue;
                     }
                     
-                    // Normalize directory path (ensure it ends with / for relative paths)
-                    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
-                        dir += "/";
-                    }
-                    if (dir == "/" || dir == "\\") {
-                        dir = "";  // Root path means empty directory
-                    }
-                    
                     // Update u and p properties
                     (*foundAsset)["u"] = dir;
                     (*foundAsset)["p"] = filename;
@@ -139,217 +432,212 @@ std::string processLayerOverrides(
                     LOG_DEBUG("Image override applied successfully for asset ID: " << assetId);
                 }
                 
-                // Serialize back to JSON
-                json_data = j.dump(4);
                 LOG_DEBUG("Assets array updated in JSON");
             } else {
                 LOG_CERR("[WARNING] Assets array not found in JSON - image overrides will not be applied") << std::endl;
             }
         } catch (const nlohmann::json::exception& e) {
-            LOG_CERR("[ERROR] Failed to parse JSON for image asset processing: " << e.what()) << std::endl;
+            LOG_CERR("[ERROR] Failed to apply image asset overrides: " << e.what()) << std::endl;
         }
     }
     
     if (layerOverrides.empty()) {
         LOG_DEBUG("No text layer overrides found in config file");
+        json_data = j.dump();
         return json_data;
     }
     
-    LOG_DEBUG("Found " << layerOverrides.size() << " text layer overrides");
-    
     // Extract animation width from JSON (for fallback text box width)
     float animationWidth = 720.0f;  // Default fallback
-    try {
-        nlohmann::json j = nlohmann::json::parse(json_data);
-        if (j.contains("w") && j["w"].is_number()) {
-            animationWidth = j["w"].get<float>();
-            LOG_DEBUG("Animation width: " << animationWidth);
-        }
-    } catch (const nlohmann::json::exception&) {
-        // Use default width if parsing fails
+    if (j.contains("w") && j["w"].is_number()) {
+        animationWidth = j["w"].get<float>();
+        LOG_DEBUG("Animation width: " << animationWidth);
     }
     
-    // Create font manager early for text measurement
-    sk_sp<SkFontMgr> tempFontMgr;
-#ifndef __EMSCRIPTEN__
-    try {
-        FcInit(); // Initialize fontconfig
-        auto scanner = SkFontScanner_Make_FreeType();
-        if (scanner) {
-            tempFontMgr = SkFontMgr_New_FontConfig(nullptr, std::move(scanner));
-        }
-    } catch (...) {
-        // Will create font manager later
-    }
-#endif
-    
-    if (!tempFontMgr) {
-        tempFontMgr = SkFontMgr::RefEmpty();
-    }
+    // Index layers by name once (top-level and precomps); every lookup below is O(1)
+    const LayerIndex layers(j);
     
     // First pass: extract all font info and calculate optimal sizes
-    struct LayerModification {
-        std::string layerName;
-        std::string textToUse;
-        float optimalSize;
-        float originalTextWidth;  // Original text width at original size
-        float newTextWidth;       // New text width at optimal size
-    };
-    std::vector<LayerModification> modifications;
-    
-    for (const auto& [layerName, config] : layerOverrides) {
-        LOG_DEBUG("Processing text layer: " << layerName);
-        
-        // Extract font info from JSON
-        FontInfo fontInfo = extractFontInfoFromJson(json_data, layerName);
-        
-        if (fontInfo.name.empty()) {
-            LOG_DEBUG("Warning: Could not find font info for layer " << layerName);
-            continue;
-        }
-        
-        // Determine text to use
-        std::string textToUse = config.value.empty() ? fontInfo.text : config.value;
-        
-        if (textToUse.empty()) {
-            LOG_DEBUG("Warning: No text value for layer " << layerName);
-            continue;
-        }
-        
-        // Determine target width (priority: config override > JSON sz > animation width)
-        float targetWidth = animationWidth;
-        if (config.textBoxWidth > 0) {
-            targetWidth = config.textBoxWidth;
-        } else if (fontInfo.textBoxWidth > 0) {
-            targetWidth = fontInfo.textBoxWidth;
-        }
-        
-        // Debug: measure current text at original size
-        float currentWidth = measureTextWidth(tempFontMgr.get(), fontInfo.family, fontInfo.style,
-                                             fontInfo.name, fontInfo.size, textToUse, textMeasurementMode);
-        LOG_DEBUG("  Original text: \"" << textToUse << "\"");
-        LOG_DEBUG("  Original size: " << fontInfo.size << ", measured width: " << currentWidth);
-        if (config.textBoxWidth > 0) {
-            LOG_DEBUG("  Text box width (from config override): " << config.textBoxWidth);
-        } else if (fontInfo.textBoxWidth > 0) {
-            LOG_DEBUG("  Text box width (from sz): " << fontInfo.textBoxWidth);
-        } else {
-            LOG_DEBUG("  Text box width: not found, using animation width");
-        }
-        LOG_DEBUG("  Target width: " << targetWidth);
-        LOG_DEBUG("  Min size: " << config.minSize << ", Max size: " << config.maxSize);
-        
-        // If minSize and maxSize are not specified, no auto-fit - just use original size or update text value
-        float optimalSize = fontInfo.size;
-        float finalWidth = 0.0f;
-        
-        if (config.minSize > 0 && config.maxSize > 0) {
-            // Apply padding to target width to prevent text from touching edges
-            // textPadding: 0.97 means 97% of target width (3% padding, 1.5% per side)
-            float paddedTargetWidth = targetWidth * textPadding;
-            LOG_DEBUG("  Padded target width: " << paddedTargetWidth << " (" << (textPadding * 100.0f) << "% of " << targetWidth << ")");
-            
-            // Calculate optimal font size
-            optimalSize = calculateOptimalFontSize(
-                tempFontMgr.get(),
-                fontInfo,
-                config,
-                textToUse,
-                paddedTargetWidth,
-                textMeasurementMode
-            );
-            
-            if (optimalSize >= 0) {
-                finalWidth = measureTextWidth(tempFontMgr.get(), fontInfo.family, fontInfo.style,
-                                             fontInfo.name, optimalSize, textToUse, textMeasurementMode);
-                LOG_DEBUG("  Optimal size: " << optimalSize << ", final width: " << finalWidth);
-            }
-            
-            if (optimalSize < 0) {
-            // Text doesn't fit even at min size, use fallback
-            float minWidth = measureTextWidth(tempFontMgr.get(), fontInfo.family, fontInfo.style,
-                                             fontInfo.name, config.minSize, textToUse, textMeasurementMode);
-            LOG_DEBUG("Text doesn't fit at min size for " << layerName << ":");
-            LOG_DEBUG("  Text length: " << textToUse.length() << " characters");
-            LOG_DEBUG("  Text content: \"" << textToUse << "\"");
-            LOG_DEBUG("  Measured width at min size (" << config.minSize << "): " << minWidth);
-            LOG_DEBUG("  Using fallback text: \"" << config.fallbackText << "\"");
-            textToUse = config.fallbackText;
-            
-            // Create a temporary fontInfo with minSize as the starting size
-            FontInfo fallbackFontInfo = fontInfo;
-            fallbackFontInfo.size = config.minSize;
-            
-            // Measure fallback text at min size
-            float fallbackMinWidth = measureTextWidth(tempFontMgr.get(), fallbackFontInfo.family, 
-                                                     fallbackFontInfo.style, fallbackFontInfo.name, 
-                                                     config.minSize, textToUse, textMeasurementMode);
-            
-            if (fallbackMinWidth > paddedTargetWidth) {
-                // Fallback doesn't fit even at min size, use min size anyway (will overflow)
-                LOG_DEBUG("  Fallback text doesn't fit at min size (" << fallbackMinWidth << " > " << paddedTargetWidth << "), using min size (will overflow)");
-                optimalSize = config.minSize;
-                finalWidth = measureTextWidth(tempFontMgr.get(), fallbackFontInfo.family,
-                                             fallbackFontInfo.style, fallbackFontInfo.name,
-                                             config.minSize, textToUse, textMeasurementMode);
-            } else {
-                // Fallback fits at min size, try to maximize up to maxSize
-                float min = config.minSize;
-                float max = config.maxSize;
-                float bestSize = config.minSize;
-                
-                for (int i = 0; i < 10; i++) {  // Binary search
-                    float testSize = (min + max) / 2.0f;
-                    float testWidth = measureTextWidth(tempFontMgr.get(), fallbackFontInfo.family,
-                                                      fallbackFontInfo.style, fallbackFontInfo.name,
-                                                      testSize, textToUse, textMeasurementMode);
-                    
-                    if (testWidth <= paddedTargetWidth) {
-                        bestSize = testSize;
-                        min = testSize;
-                    } else {
-                        max = testSize;
-                    }
-                }
-                
-                optimalSize = std::min(bestSize, config.maxSize);
-                finalWidth = measureTextWidth(tempFontMgr.get(), fallbackFontInfo.family,
-                                             fallbackFontInfo.style, fallbackFontInfo.name,
-                                             optimalSize, textToUse, textMeasurementMode);
-                LOG_DEBUG("  Fallback text optimal size: " << optimalSize << " (width: " << finalWidth << " / " << paddedTargetWidth << ")");
-            }
-            }
-        } else {
-            // No auto-fit, just measure at original size
-            finalWidth = currentWidth;
-            optimalSize = fontInfo.size;
-            LOG_DEBUG("  No auto-fit (minSize/maxSize not specified), using original size: " << optimalSize);
-        }
-        
-        // Store original and new text widths for position adjustment
-        float originalTextWidth = currentWidth;
-        float newTextWidth = finalWidth;
-        
-        modifications.push_back({layerName, textToUse, optimalSize, originalTextWidth, newTextWidth});
-    }
+    const auto modifications = computeTextModifications(
+        layerOverrides,
+        [&j, &layers](const std::string& layerName) { return extractFontInfoFromJson(j, layers, layerName); },
+        animationWidth, textPadding, textMeasurementMode, fontMgr);
     
     // Second pass: apply modifications in reverse order (from end to start)
     // This prevents position shifts from affecting subsequent modifications
     for (auto it = modifications.rbegin(); it != modifications.rend(); ++it) {
-        modifyTextLayerInJson(json_data, it->layerName, it->textToUse, it->optimalSize);
+        modifyTextLayerInJson(layers, it->layerName, it->textToUse, it->optimalSize);
         
         // Adjust text animator position keyframes based on text width change
-        float widthDiff = it->newTextWidth - it->originalTextWidth;
-        if (std::abs(widthDiff) > 0.1f) {  // Only adjust if there's a significant change
-            // Always move further left by the absolute difference to ensure text stays off-screen
-            float adjustment = std::abs(widthDiff);
-            adjustTextAnimatorPosition(json_data, it->layerName, adjustment);
-            LOG_DEBUG("Adjusted text animator position for " << it->layerName << " by " << adjustment << "px (widthDiff: " << widthDiff << ")");
+        const float adjustment = animatorAdjustment(*it);
+        if (adjustment > 0.0f) {
+            adjustTextAnimatorPosition(layers, it->layerName, adjustment);
+            LOG_DEBUG("Adjusted text animator position for " << it->layerName << " by " << adjustment << "px (widthDiff: " << (it->newTextWidth - it->originalTextWidth) << ")");
         }
         
         LOG_DEBUG("Updated " << it->layerName << ": text=\"" << it->textToUse << "\", size=" << it->optimalSize);
     }
     
+    json_data = j.dump();
     return json_data;
 }
 
+// Whether member `key` of the object at `object` can be spliced: its current value is recorded, or
+// the object has members to insert it before (an empty object would need a different splice)
+static bool canSpliceMember(const char* json, ByteRange object, ByteRange current) {
+    if (!current.empty()) {
+        return true;
+    }
+    for (size_t i = object.begin + 1; i + 1 < object.end; ++i) {
+        if (json[i] != ' ' && json[i] != '\n' && json[i] != '\r' && json[i] != '\t') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Set member `key` of the object at `object` to the serialized `value`: replace its current value,
+// or insert the member when the object does not have it (canSpliceMember() must hold)
+static void spliceMember(
+    ByteRange object,
+    ByteRange current,
+    const char* key,
+    std::string value,
+    std::vector<JsonSplice>& splices
+) {
+    if (!current.empty()) {
+        splices.push_back({current.begin, current.end, std::move(value)});
+    } else {
+        splices.push_back({object.begin + 1, object.begin + 1, "\"" + std::string(key) + "\":" + value + ","});
+    }
+}
+
+// Whether every edit the overrides can make has splice offsets in the template
+// Checked before any text is fitted, so a parsed-document fallback neither fits the layers nor
+// logs the override warnings a second time
+static bool canSpliceOverrides(
+    const OverrideTemplate& tmpl,
+    const char* json,
+    const std::map<std::string, LayerOverride>& layerOverrides,
+    const std::map<std::string, ImageLayerOverride>& imageLayers
+) {
+    for (const auto& entry : imageLayers) {
+        const auto asset = tmpl.assets.find(entry.first);
+        if (asset != tmpl.assets.end() &&
+            (!canSpliceMember(json, asset->second.object, asset->second.u) ||
+             !canSpliceMember(json, asset->second.object, asset->second.p))) {
+            LOG_DEBUG("Asset " << entry.first << " cannot be spliced");
+            return false;
+        }
+    }
+    for (const auto& entry : layerOverrides) {
+        const auto textLayer = tmpl.text_layers.find(entry.first);
+        if (textLayer != tmpl.text_layers.end() && !textLayer->second.style.empty() &&
+            (!canSpliceMember(json, textLayer->second.style, textLayer->second.text) ||
+             !canSpliceMember(json, textLayer->second.style, textLayer->second.size))) {
+            LOG_DEBUG("Text layer " << entry.first << " cannot be spliced");
+            return false;
+        }
+        // The position adjustment is only known after fitting; require it to be spliceable up front
+        const auto animator = tmpl.animator_layers.find(entry.first);
+        if (animator != tmpl.animator_layers.end() && animator->second.adjustable && !animator->second.exact) {
+            LOG_DEBUG("Text animator of " << entry.first << " has non-numeric keyframes and cannot be spliced");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool spliceLayerOverrides(
+    const OverrideTemplate& tmpl,
+    const char* json,
+    size_t size,
+    const std::string& layer_overrides_file,
+    std::string& json_out,
+    float textPadding,
+    TextMeasurementMode textMeasurementMode,
+    SkFontMgr* fontMgr
+) {
+    std::map<std::string, LayerOverride> layerOverrides;
+    std::map<std::string, ImageLayerOverride> imageLayers;
+    if (layer_overrides_file.empty() ||
+        !loadLayerOverrides(layer_overrides_file, textPadding, textMeasurementMode, layerOverrides, imageLayers)) {
+        json_out.assign(json, size);
+        return true;
+    }
+
+    if (!canSpliceOverrides(tmpl, json, layerOverrides, imageLayers)) {
+        return false;
+    }
+
+    std::vector<JsonSplice> splices;
+    try {
+        if (!imageLayers.empty()) {
+            LOG_DEBUG("Found " << imageLayers.size() << " image layer overrides");
+            if (tmpl.has_assets) {
+                for (const auto& [assetId, imageConfig] : imageLayers) {
+                    LOG_DEBUG("Processing image override for asset ID: " << assetId);
+                    const auto found = tmpl.assets.find(assetId);
+                    if (found == tmpl.assets.end()) {
+                        LOG_CERR("[WARNING] Asset ID " << assetId << " not found in assets array") << std::endl;
+                        continue;
+                    }
+                    const auto& asset = found->second;
+
+                    std::string dir;
+                    std::string filename;
+                    if (!resolveImageOverridePath(assetId, imageConfig, asset.has_p_string ? &asset.p_value : nullptr,
+                                                  dir, filename)) {
+                        continue;
+                    }
+                    spliceMember(asset.object, asset.u, "u", nlohmann::json(dir).dump(), splices);
+                    spliceMember(asset.object, asset.p, "p", nlohmann::json(filename).dump(), splices);
+                    LOG_DEBUG("Updated asset " << assetId << ": u=\"" << dir << "\", p=\"" << filename << "\"");
+                }
+            } else {
+                LOG_CERR("[WARNING] Assets array not found in JSON - image overrides will not be applied") << std::endl;
+            }
+        }
+
+        if (!layerOverrides.empty()) {
+            const auto modifications = computeTextModifications(
+                layerOverrides,
+                [&tmpl](const std::string& layerName) {
+                    const auto found = tmpl.text_layers.find(layerName);
+                    return found != tmpl.text_layers.end() ? found->second.font : FontInfo{};
+                },
+                tmpl.animation_width, textPadding, textMeasurementMode, fontMgr);
+
+            for (const auto& modification : modifications) {
+                const auto textLayer = tmpl.text_layers.find(modification.layerName);
+                if (textLayer != tmpl.text_layers.end() && !textLayer->second.style.empty()) {
+                    const auto& layer = textLayer->second;
+                    spliceMember(layer.style, layer.text, "t", nlohmann::json(modification.textToUse).dump(), splices);
+                    spliceMember(layer.style, layer.size, "s", nlohmann::json(modification.optimalSize).dump(), splices);
+                } else {
+                    LOG_DEBUG("Warning: Could not find text style object for layer: " << modification.layerName);
+                }
+
+                const float adjustment = animatorAdjustment(modification);
+                const auto animator = tmpl.animator_layers.find(modification.layerName);
+                if (adjustment > 0.0f && animator != tmpl.animator_layers.end() && animator->second.adjustable) {
+                    for (size_t i = 0; i < animator->second.x.size(); i++) {
+                        const float newX = animator->second.x_values[i] - adjustment;
+                        splices.push_back({animator->second.x[i].begin, animator->second.x[i].end,
+                                           nlohmann::json(newX).dump()});
+                    }
+                    LOG_DEBUG("Adjusted text animator position for " << modification.layerName << " by " << adjustment << "px");
+                }
+
+                LOG_DEBUG("Updated " << modification.layerName << ": text=\"" << modification.textToUse << "\", size=" << modification.optimalSize);
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        LOG_DEBUG("Could not serialize an override value for splicing: " << e.what());
+        return false;
+    }
+
+    LOG_DEBUG("Applied layer overrides as " << splices.size() << " splices into the template JSON");
+    json_out = applyJsonSplices(json, size, std::move(splices));
+    return true;
+}
@@ -3,16 +3,35 @@
 
 #include <string>
 #include "font_utils.h"
+#include "override_template.h"
 
 // Process JSON with layer overrides (text auto-fit, dynamic text values, and image path overrides)
-// Returns processed JSON string, or empty string on error
+// The JSON is parsed once, all overrides are applied to the parsed document, and it is
+// serialized once (compact). Returns the processed JSON string (also stored in json_data)
 // textPadding: padding factor (0.0-1.0), default 0.97 means 97% of target width (3% padding)
 // textMeasurementMode: measurement accuracy mode (default: ACCURATE for good balance)
+// fontMgr: font manager used for text measurement (nullptr uses sharedFontManager())
 std::string processLayerOverrides(
     std::string& json_data,
     const std::string& layer_overrides_file,
     float textPadding = 0.97f,
-    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE
+    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE,
+    SkFontMgr* fontMgr = nullptr
+);
+
+// Same as processLayerOverrides() for a template compiled with compileOverrideTemplate(): the new
+// values are spliced into the template bytes at the recorded offsets, without parsing the JSON
+// Returns false (json_out unspecified) when an override needs an edit the template has no offsets
+// for; callers then use processLayerOverrides()
+bool spliceLayerOverrides(
+    const OverrideTemplate& tmpl,
+    const char* json,
+    size_t size,
+    const std::string& layer_overrides_file,
+    std::string& json_out,
+    float textPadding = 0.97f,
+    TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE,
+    SkFontMgr* fontMgr = nullptr
 );
 
 #endif // TEXT_PROCESSOR_H
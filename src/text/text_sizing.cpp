@@ -3,22 +3,168 @@
 #include "../utils/logging.h"
 #include <algorithm>
 
-float calculateOptimalFontSize(
+// The solver aims slightly under the target so predictions land on the fitting side, and stops
+// once the fitted width is within kWidthTolerance of the target or the fitting size is within
+// kSizeTolerance points of the smallest size known not to fit
+static constexpr float kWidthTolerance = 0.002f;
+static constexpr float kSizeTolerance = 0.05f;
+static constexpr int kMaxSolverMeasurements = 6;
+
+float solveFittingFontSize(
+    const std::function<float(float)>& measureAtSize,
+    float fitSize,
+    float fitWidth,
+    float maxSize,
+    float targetWidth,
+    float overSize,
+    float overWidth
+) {
+    const float aim = targetWidth * (1.0f - kWidthTolerance * 0.5f);
+
+    // Bracket: the largest size known to fit and, once measured, the smallest size known not to.
+    // Widths are kept relative to the aim; the Illinois rule halves the value of an end that is
+    // kept twice in a row so the prediction cannot stall next to it (hinting makes the width a
+    // step function of the size). The halved value only steers interpolation; the stop test uses
+    // the width actually measured at fitS.
+    float fitS = fitSize;
+    float fitF = fitWidth - aim;
+    float fitMeasured = fitWidth;
+    float prevFitS = 0.0f;  // Previous fitting point (the origin: no text width at size 0)
+    float prevFitF = -aim;
+    bool haveOver = overSize > fitSize && overSize <= maxSize;
+    float overS = haveOver ? overSize : maxSize;
+    float overF = haveOver ? overWidth - aim : 0.0f;
+    int lastSide = 0;  // 1: last measurement fit, -1: it did not
+
+    for (int i = 0; i < kMaxSolverMeasurements; i++) {
+        if (targetWidth - fitMeasured <= targetWidth * kWidthTolerance || overS - fitS < kSizeTolerance) {
+            break;
+        }
+
+        float predicted;
+        if (haveOver) {
+            predicted = fitS - fitF * (overS - fitS) / (overF - fitF);
+        } else if (fitF != prevFitF) {
+            // Secant through the two largest fitting sizes (proportional from the origin at first)
+            predicted = fitS - fitF * (fitS - prevFitS) / (fitF - prevFitF);
+        } else {
+            predicted = maxSize;  // Width does not change with size (e.g. empty text)
+        }
+        const float margin = kSizeTolerance * 0.5f;
+        predicted = std::max(predicted, fitS + margin);
+        predicted = haveOver ? std::min(predicted, overS - margin) : std::min(predicted, maxSize);
+
+        const float width = measureAtSize(predicted);
+        if (width <= targetWidth) {
+            prevFitS = fitS;
+            prevFitF = fitMeasured - aim;
+            fitS = predicted;
+            fitF = width - aim;
+            fitMeasured = width;
+            if (lastSide == 1 && haveOver) {
+                overF *= 0.5f;
+            }
+            lastSide = 1;
+            if (!haveOver && fitS >= maxSize) {
+                break;
+            }
+        } else {
+            overS = predicted;
+            overF = width - aim;
+            if (lastSide == -1) {
+                fitF *= 0.5f;
+            }
+            haveOver = true;
+            lastSide = -1;
+        }
+    }
+    return fitS;
+}
+
+TextMeasurementMode searchMeasurementMode(TextMeasurementMode mode) {
+    return mode == TextMeasurementMode::HYBRID ? TextMeasurementMode::ACCURATE : mode;
+}
+
+float verifyFittingFontSize(
+    const std::function<float(float)>& measurePixels,
+    float size,
+    float minSize,
+    float targetWidth
+) {
+    float width = measurePixels(size);
+    if (width <= targetWidth) {
+        return size;
+    }
+    const float lowest = std::min(minSize, size);
+    if (size <= lowest) {
+        return -1.0f;
+    }
+
+    // Step down once to the size the pixel overflow predicts
+    float neighbour = std::max(lowest, size * (targetWidth / width) * (1.0f - kWidthTolerance));
+    float neighbourWidth = measurePixels(neighbour);
+    if (g_debug_mode) {
+        LOG_COUT("[DEBUG] verifyFittingFontSize: " << size << " overflows in pixels (" << width << " > " << targetWidth
+                 << "), neighbour " << neighbour << " width " << neighbourWidth) << std::endl;
+    }
+    if (neighbourWidth <= targetWidth) {
+        return neighbour;
+    }
+    if (neighbour <= lowest) {
+        return -1.0f;
+    }
+
+    // Still overflows (rare): solve with pixel widths below the neighbour
+    float lowestWidth = measurePixels(lowest);
+    if (lowestWidth > targetWidth) {
+        return -1.0f;
+    }
+    return solveFittingFontSize(measurePixels, lowest, lowestWidth, neighbour, targetWidth, neighbour, neighbourWidth);
+}
+
+float fitFontSizeFromMinimum(
     SkFontMgr* fontMgr,
     const FontInfo& fontInfo,
     const LayerOverride& config,
     const std::string& text,
     float targetWidth,
+    float minWidth,
     TextMeasurementMode mode
 ) {
-    if (targetWidth <= 0) {
-        return fontInfo.size;  // No constraint, use original size
+    const TextMeasurementMode searchMode = searchMeasurementMode(mode);
+    auto measureAtSize = [&](float size) {
+        return measureTextWidth(fontMgr, fontInfo.family, fontInfo.style, fontInfo.name, size, text, searchMode);
+    };
+    float searchMinWidth = (searchMode == mode) ? minWidth : measureAtSize(config.minSize);
+    float bestSize = solveFittingFontSize(measureAtSize, config.minSize, searchMinWidth, config.maxSize, targetWidth);
+
+    if (searchMode != mode) {
+        auto measurePixels = [&](float size) {
+            return measureTextWidth(fontMgr, fontInfo.family, fontInfo.style, fontInfo.name, size, text,
+                                    TextMeasurementMode::PIXEL_PERFECT);
+        };
+        // The text fits in pixels at minSize, so verification finds a fitting size
+        bestSize = std::max(verifyFittingFontSize(measurePixels, bestSize, config.minSize, targetWidth), config.minSize);
     }
+    return std::min(bestSize, config.maxSize);
+}
+
+// Font-size search with one measurement mode (see calculateOptimalFontSize)
+static float searchOptimalFontSize(
+    SkFontMgr* fontMgr,
+    const FontInfo& fontInfo,
+    const LayerOverride& config,
+    const std::string& text,
+    float targetWidth,
+    TextMeasurementMode mode
+) {
+    auto measureAtSize = [&](float size) {
+        return measureTextWidth(fontMgr, fontInfo.family, fontInfo.style, fontInfo.name, size, text, mode);
+    };
     
     // Measure with current size
     float currentSize = fontInfo.size;
-    float currentWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style, 
-                                         fontInfo.name, currentSize, text, mode);
+    float currentWidth = measureAtSize(currentSize);
     
     if (g_debug_mode) {
         LOG_COUT("[DEBUG] calculateOptimalFontSize: text=\"" << text << "\", currentSize=" << currentSize 
@@ -27,30 +173,14 @@ float calculateOptimalFontSize(
     
     // If text fits, try to maximize size up to maxSize
     if (currentWidth <= targetWidth) {
-        // Binary search for maximum size that fits
-        float min = currentSize;
-        float max = config.maxSize;
-        float bestSize = currentSize;
-        
-        for (int i = 0; i < 10; i++) {  // 10 iterations should be enough
-            float testSize = (min + max) / 2.0f;
-            float testWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
-                                              fontInfo.name, testSize, text, mode);
-            
-            if (testWidth <= targetWidth) {
-                bestSize = testSize;
-                min = testSize;
-            } else {
-                max = testSize;
-            }
+        if (config.maxSize <= currentSize) {
+            return config.maxSize;
         }
-        
-        return std::min(bestSize, config.maxSize);
+        return solveFittingFontSize(measureAtSize, currentSize, currentWidth, config.maxSize, targetWidth);
     } else {
         // Text too wide, reduce size
         // First check if it fits at minimum size
-        float minWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
-                                         fontInfo.name, config.minSize, text, mode);
+        float minWidth = measureAtSize(config.minSize);
         if (minWidth > targetWidth) {
             // Doesn't fit even at min size - return -1 to indicate fallback needed
             if (g_debug_mode) {
@@ -60,34 +190,12 @@ float calculateOptimalFontSize(
             return -1.0f;
         }
         
-        // Binary search for maximum size that fits (between minSize and currentSize)
-        float min = config.minSize;
-        float max = currentSize;
-        float bestSize = config.minSize;  // Start with minSize as the best we know fits
-        
-        for (int i = 0; i < 15; i++) {  // More iterations for better precision
-            float testSize = (min + max) / 2.0f;
-            float testWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
-                                              fontInfo.name, testSize, text, mode);
-            
-            if (testWidth <= targetWidth) {
-                // This size fits, try larger
-                bestSize = testSize;
-                min = testSize;
-            } else {
-                // This size doesn't fit, try smaller
-                max = testSize;
-            }
-            
-            // Early exit if we're close enough
-            if ((max - min) < 0.1f) {
-                break;
-            }
-        }
+        // Largest size that fits between minSize (fits) and currentSize (too wide)
+        float bestSize = solveFittingFontSize(measureAtSize, config.minSize, minWidth, currentSize, targetWidth,
+                                              currentSize, currentWidth);
         
         if (g_debug_mode) {
-            float finalWidth = measureTextWidth(fontMgr, fontInfo.family, fontInfo.style,
-                                               fontInfo.name, bestSize, text, mode);
+            float finalWidth = measureAtSize(bestSize);
             LOG_COUT("[DEBUG] calculateOptimalFontSize: reduced from " << currentSize 
                      << " to " << bestSize << " (width: " << finalWidth << " / " << targetWidth << ")") << std::endl;
         }
@@ -96,3 +204,31 @@ float calculateOptimalFontSize(
     }
 }
 
+float calculateOptimalFontSize(
+    SkFontMgr* fontMgr,
+    const FontInfo& fontInfo,
+    const LayerOverride& config,
+    const std::string& text,
+    float targetWidth,
+    TextMeasurementMode mode
+) {
+    if (targetWidth <= 0) {
+        return fontInfo.size;  // No constraint, use original size
+    }
+    
+    float bestSize = searchOptimalFontSize(fontMgr, fontInfo, config, text, targetWidth, searchMeasurementMode(mode));
+    if (mode != TextMeasurementMode::HYBRID || bestSize < 0) {
+        return bestSize;
+    }
+    
+    // HYBRID: verify the ACCURATE result with the pixel measurement
+    auto measurePixels = [&](float size) {
+        return measureTextWidth(fontMgr, fontInfo.family, fontInfo.style, fontInfo.name, size, text,
+                                TextMeasurementMode::PIXEL_PERFECT);
+    };
+    float verifiedSize = verifyFittingFontSize(measurePixels, bestSize, config.minSize, targetWidth);
+    if (g_debug_mode && verifiedSize != bestSize) {
+        LOG_COUT("[DEBUG] calculateOptimalFontSize: pixel verification moved " << bestSize << " to " << verifiedSize) << std::endl;
+    }
+    return verifiedSize;
+}
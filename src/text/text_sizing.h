@@ -4,9 +4,58 @@
 #include "font_utils.h"
 #include "layer_overrides.h"
 #include "include/core/SkFontMgr.h"
+#include <functional>
 #include <string>
 
+// Largest font size in [fitSize, maxSize] whose measured width fits targetWidth
+// Text width is close to linear in the font size, so instead of bisecting the range the size is
+// predicted from the measurements so far (secant from the largest fitting sizes, then regula falsi
+// between the largest fitting and smallest non-fitting size, which tolerates hinting steps) and
+// verified, using at most six more measurements (typically two or three). The result always has
+// a verified fitting width.
+// measureAtSize: width of the text at a font size
+// fitSize/fitWidth: a measured size that fits
+// overSize/overWidth: optional measured size (> fitSize) that does not fit (0 = none)
+float solveFittingFontSize(
+    const std::function<float(float)>& measureAtSize,
+    float fitSize,
+    float fitWidth,
+    float maxSize,
+    float targetWidth,
+    float overSize = 0.0f,
+    float overWidth = 0.0f
+);
+
+// Measurement mode of a font-size search: HYBRID searches with ACCURATE bounds, other modes with
+// themselves
+TextMeasurementMode searchMeasurementMode(TextMeasurementMode mode);
+
+// HYBRID verification of a font size found with ACCURATE widths against the pixel measurement
+// Pixel widths are never below ACCURATE widths, so only an overflow needs correcting: returns size
+// if its pixel width fits, otherwise steps down once to the size the overflow predicts and, only
+// if that still overflows, solves with pixel widths down to minSize. Returns -1 if the text does
+// not fit in pixels even at minSize.
+float verifyFittingFontSize(
+    const std::function<float(float)>& measurePixels,
+    float size,
+    float minSize,
+    float targetWidth
+);
+
+// Largest font size in [config.minSize, config.maxSize] for text that fits at minSize
+// minWidth: width at minSize, measured with mode (used for fallback text)
+float fitFontSizeFromMinimum(
+    SkFontMgr* fontMgr,
+    const FontInfo& fontInfo,
+    const LayerOverride& config,
+    const std::string& text,
+    float targetWidth,
+    float minWidth,
+    TextMeasurementMode mode
+);
+
 // Calculate optimal font size for text to fit
+// Returns -1 if the text does not fit at config.minSize (fallback text needed)
 float calculateOptimalFontSize(
     SkFontMgr* fontMgr,
     const FontInfo& fontInfo,
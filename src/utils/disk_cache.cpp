@@ -0,0 +1,185 @@
+#include "disk_cache.h"
+#include "logging.h"
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Staging and pinned directories start with '.' so lookups and eviction never treat them as entries
+static const char* kStagingPrefix = ".staging-";
+static const char* kPinPrefix = ".pin-";
+static const char* kTrashPrefix = ".trash-";
+
+// Staging/pin directories older than this are leftovers of crashed processes
+static const auto kStaleAge = std::chrono::hours(1);
+
+DiskCache::DiskCache(const std::string& root, uint64_t maxBytes)
+    : fRoot(root), fMaxBytes(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(fRoot, ec);
+    fValid = !ec && fs::is_directory(fRoot, ec);
+    if (!fValid) {
+        LOG_CERR("[WARNING] Cache directory is not usable, caching disabled: " << fRoot) << std::endl;
+    }
+}
+
+std::string DiskCache::uniqueSuffix() const {
+    static std::atomic<uint64_t> counter(0);
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    return std::to_string(getpid()) + "-" + std::to_string(now) + "-" + std::to_string(counter++);
+}
+
+bool DiskCache::lookup(const std::string& key, std::string& entryDir) const {
+    if (!fValid) {
+        return false;
+    }
+    fs::path dir = fs::path(fRoot) / key;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        return false;
+    }
+    // Refresh mtime: it is the LRU timestamp used by evict()
+    fs::last_write_time(dir, fs::file_time_type::clock::now(), ec);
+    entryDir = dir.string();
+    return true;
+}
+
+std::string DiskCache::pin(const std::string& key) const {
+    std::string entryDir;
+    if (!lookup(key, entryDir)) {
+        return "";
+    }
+    fs::path pinned = fs::path(fRoot) / (std::string(kPinPrefix) + uniqueSuffix());
+    std::error_code ec;
+    if (!fs::create_directory(pinned, ec)) {
+        return "";
+    }
+    for (const auto& file : fs::directory_iterator(entryDir, ec)) {
+        fs::create_hard_link(file.path(), pinned / file.path().filename(), ec);
+        if (ec) {
+            // Entry evicted while pinning (or hard links unsupported) - treat as a miss
+            LOG_DEBUG("[CACHE] Could not pin " << file.path().string() << ": " << ec.message());
+            release(pinned.string());
+            return "";
+        }
+    }
+    if (ec) {
+        release(pinned.string());
+        return "";
+    }
+    return pinned.string();
+}
+
+void DiskCache::release(const std::string& pinnedDir) const {
+    std::error_code ec;
+    fs::remove_all(pinnedDir, ec);
+}
+
+std::string DiskCache::beginEntry(const std::string& key) const {
+    if (!fValid) {
+        return "";
+    }
+    fs::path staging = fs::path(fRoot) / (std::string(kStagingPrefix) + key + "-" + uniqueSuffix());
+    std::error_code ec;
+    if (!fs::create_directory(staging, ec)) {
+        LOG_CERR("[WARNING] Could not create cache staging directory: " << staging.string()) << std::endl;
+        return "";
+    }
+    return staging.string();
+}
+
+bool DiskCache::commitEntry(const std::string& key, const std::string& stagingDir) const {
+    fs::path target = fs::path(fRoot) / key;
+    std::error_code ec;
+    fs::rename(stagingDir, target, ec);
+    if (ec) {
+        // rename() onto an existing non-empty directory fails: another process published first
+        abortEntry(stagingDir);
+        if (!fs::is_directory(target)) {
+            LOG_CERR("[WARNING] Could not publish cache entry " << key << ": " << ec.message()) << std::endl;
+            return false;
+        }
+        LOG_DEBUG("[CACHE] Entry " << key << " was published concurrently; keeping existing entry");
+    } else {
+        LOG_DEBUG("[CACHE] Published entry " << key);
+    }
+    evict();
+    return true;
+}
+
+void DiskCache::abortEntry(const std::string& stagingDir) const {
+    std::error_code ec;
+    fs::remove_all(stagingDir, ec);
+}
+
+void DiskCache::evict() const {
+    if (!fValid) {
+        return;
+    }
+
+    struct Entry {
+        fs::path path;
+        fs::file_time_type mtime;
+        uint64_t bytes;
+    };
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    const auto now = fs::file_time_type::clock::now();
+
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(fRoot, ec)) {
+        const std::string name = item.path().filename().string();
+        std::error_code itemEc;
+        auto mtime = fs::last_write_time(item.path(), itemEc);
+        if (itemEc) {
+            continue;
+        }
+        if (!name.empty() && name[0] == '.') {
+            // Clean up staging/pin/trash directories left behind by crashed processes
+            if (now - mtime > kStaleAge) {
+                fs::remove_all(item.path(), itemEc);
+            }
+            continue;
+        }
+        if (name[0] == '_' || !item.is_directory(itemEc)) {
+            continue;  // Nested cache or stray file
+        }
+        uint64_t bytes = 0;
+        for (const auto& file : fs::recursive_directory_iterator(item.path(), itemEc)) {
+            std::error_code sizeEc;
+            if (file.is_regular_file(sizeEc)) {
+                bytes += file.file_size(sizeEc);
+            }
+        }
+        entries.push_back({item.path(), mtime, bytes});
+        totalBytes += bytes;
+    }
+
+    if (fMaxBytes == 0 || totalBytes <= fMaxBytes) {
+        return;
+    }
+
+    // Oldest first
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.mtime < b.mtime;
+    });
+    for (const auto& entry : entries) {
+        if (totalBytes <= fMaxBytes) {
+            break;
+        }
+        // Rename out of the way first so lookups never see a half-deleted entry
+        fs::path trash = fs::path(fRoot) / (std::string(kTrashPrefix) + uniqueSuffix());
+        std::error_code removeEc;
+        fs::rename(entry.path, trash, removeEc);
+        if (removeEc) {
+            continue;  // Already evicted by another process
+        }
+        fs::remove_all(trash, removeEc);
+        totalBytes -= entry.bytes;
+        LOG_DEBUG("[CACHE] Evicted " << entry.path.filename().string() << " (" << entry.bytes << " bytes)");
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+#include <string>
+#include <cstdint>
+
+// Content-addressed on-disk cache shared between lotio processes
+// Each entry is a directory <root>/<key>/ published atomically:
+//   - writers populate a private staging directory and rename() it into place,
+//     so readers never observe a partially written entry
+//   - if two processes publish the same key, the first rename wins and the other is discarded
+// Entries are evicted least-recently-used first (by directory mtime, refreshed on every hit)
+// once the total size exceeds maxBytes (0 = unbounded)
+// Names starting with '_' are reserved for caches nested in the root (e.g. the text-fit cache):
+// they are never keys and eviction leaves them alone
+class DiskCache {
+public:
+    DiskCache(const std::string& root, uint64_t maxBytes);
+
+    // True if the cache root exists (or was created) and is usable
+    bool valid() const { return fValid; }
+    const std::string& root() const { return fRoot; }
+
+    // Look up an entry; on hit returns true, sets entryDir and marks the entry as recently used
+    bool lookup(const std::string& key, std::string& entryDir) const;
+
+    // Pin an entry for reading: hard-link its files into a private directory so a concurrent
+    // eviction cannot remove them mid-read. Returns the pinned directory, or "" on failure
+    // The caller removes the pinned directory with release()
+    std::string pin(const std::string& key) const;
+    void release(const std::string& pinnedDir) const;
+
+    // Create a private staging directory for a new entry; returns "" on failure
+    std::string beginEntry(const std::string& key) const;
+
+    // Publish a staging directory as <root>/<key>/ and enforce the size limit
+    // Returns true if the entry is available afterwards (published here or by another process)
+    bool commitEntry(const std::string& key, const std::string& stagingDir) const;
+
+    // Discard a staging directory without publishing it
+    void abortEntry(const std::string& stagingDir) const;
+
+    // Evict least-recently-used entries until the cache fits in maxBytes
+    void evict() const;
+
+private:
+    std::string uniqueSuffix() const;
+
+    std::string fRoot;
+    uint64_t fMaxBytes;
+    bool fValid = false;
+};
+
+#endif // DISK_CACHE_H
@@ -0,0 +1,125 @@
+#include "profiler.h"
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+bool g_profile_startup = false;
+
+namespace {
+
+struct PhaseRecord {
+    std::string name;
+    int depth = 0;
+    double start_ms = 0.0;   // Relative to the first recorded phase
+    double wall_ms = -1.0;   // -1 while the phase is running
+    int64_t rss_delta = 0;
+    int64_t rss_after = 0;
+};
+
+std::mutex g_phaseMutex;
+std::vector<PhaseRecord> g_phases;
+std::chrono::steady_clock::time_point g_profileOrigin;
+thread_local int t_phaseDepth = 0;
+
+double millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+int64_t currentRssBytes() {
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<int64_t>(info.resident_size);
+    }
+    return 0;
+#elif defined(__linux__)
+    // /proc/self/statm: total and resident sizes in pages
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) {
+        return 0;
+    }
+    long long totalPages = 0;
+    long long residentPages = 0;
+    int fields = std::fscanf(statm, "%lld %lld", &totalPages, &residentPages);
+    std::fclose(statm);
+    return (fields == 2) ? residentPages * static_cast<int64_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+ScopedPhase::ScopedPhase(const char* name) {
+    if (!g_profile_startup) {
+        return;
+    }
+    fStartRss = currentRssBytes();
+    fStart = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(g_phaseMutex);
+    if (g_phases.empty()) {
+        g_profileOrigin = fStart;
+    }
+    PhaseRecord record;
+    record.name = name;
+    record.depth = t_phaseDepth++;
+    record.start_ms = millisecondsBetween(g_profileOrigin, fStart);
+    fIndex = static_cast<int>(g_phases.size());
+    g_phases.push_back(std::move(record));
+}
+
+void ScopedPhase::end() {
+    if (fIndex < 0) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    int64_t rss = currentRssBytes();
+    t_phaseDepth--;
+
+    std::lock_guard<std::mutex> lock(g_phaseMutex);
+    if (fIndex < static_cast<int>(g_phases.size())) {
+        PhaseRecord& record = g_phases[fIndex];
+        record.wall_ms = millisecondsBetween(fStart, now);
+        record.rss_delta = rss - fStartRss;
+        record.rss_after = rss;
+    }
+    fIndex = -1;
+}
+
+void printStartupProfile() {
+    if (!g_profile_startup) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_phaseMutex);
+    if (g_phases.empty()) {
+        return;
+    }
+
+    // Always stderr: stdout may carry the PNG stream
+    std::cerr << "[PROFILE] Startup phases (start and wall time in ms, RSS in KB):" << std::endl;
+    std::cerr << std::fixed << std::setprecision(2);
+    for (const auto& record : g_phases) {
+        std::string label = std::string(record.depth * 2, ' ') + record.name;
+        std::cerr << "[PROFILE]   " << std::left << std::setw(44) << label << std::right
+                  << " start=" << std::setw(9) << record.start_ms;
+        if (record.wall_ms < 0.0) {
+            std::cerr << " wall=  (unfinished)" << std::endl;
+            continue;
+        }
+        std::cerr << " wall=" << std::setw(9) << record.wall_ms
+                  << " rss_delta=" << std::showpos << std::setw(8) << (record.rss_delta / 1024) << std::noshowpos
+                  << " rss=" << std::setw(8) << (record.rss_after / 1024) << std::endl;
+    }
+    std::cerr << std::defaultfloat;
+    g_phases.clear();
+}
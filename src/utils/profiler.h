@@ -0,0 +1,35 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+
+// Startup phase profiler (--profile-startup)
+// Phases record wall time and the change in resident set size; nested phases are reported
+// indented under their parent. Everything is a no-op unless g_profile_startup is set.
+extern bool g_profile_startup;
+
+class ScopedPhase {
+public:
+    explicit ScopedPhase(const char* name);
+    ~ScopedPhase() { end(); }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    // Finish the phase before the end of the scope (later calls do nothing)
+    void end();
+
+private:
+    int fIndex = -1;  // Record index, -1 when not profiling or already ended
+    std::chrono::steady_clock::time_point fStart;
+    int64_t fStartRss = 0;
+};
+
+// Current resident set size in bytes (0 if unavailable on this platform)
+int64_t currentRssBytes();
+
+// Print the recorded phases to stderr, in start order, and clear them
+void printStartupProfile();
+
+#endif // PROFILER_H
@@ -0,0 +1,130 @@
+#include "sha256.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+}  // namespace
+
+Sha256::Sha256() {
+    fState[0] = 0x6a09e667;
+    fState[1] = 0xbb67ae85;
+    fState[2] = 0x3c6ef372;
+    fState[3] = 0xa54ff53a;
+    fState[4] = 0x510e527f;
+    fState[5] = 0x9b05688c;
+    fState[6] = 0x1f83d9ab;
+    fState[7] = 0x5be0cd19;
+}
+
+void Sha256::processBlock(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+               (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = fState[0], b = fState[1], c = fState[2], d = fState[3];
+    uint32_t e = fState[4], f = fState[5], g = fState[6], h = fState[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + S1 + ch + kRoundConstants[i] + w[i];
+        uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = S0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    fState[0] += a; fState[1] += b; fState[2] += c; fState[3] += d;
+    fState[4] += e; fState[5] += f; fState[6] += g; fState[7] += h;
+}
+
+void Sha256::update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    fTotalLength += length;
+
+    // Fill a partially filled block first
+    if (fBufferLength > 0) {
+        size_t take = std::min(length, sizeof(fBuffer) - fBufferLength);
+        std::memcpy(fBuffer + fBufferLength, bytes, take);
+        fBufferLength += take;
+        bytes += take;
+        length -= take;
+        if (fBufferLength == sizeof(fBuffer)) {
+            processBlock(fBuffer);
+            fBufferLength = 0;
+        }
+    }
+
+    // Hash full blocks directly from the input
+    while (length >= sizeof(fBuffer)) {
+        processBlock(bytes);
+        bytes += sizeof(fBuffer);
+        length -= sizeof(fBuffer);
+    }
+
+    if (length > 0) {
+        std::memcpy(fBuffer, bytes, length);
+        fBufferLength = length;
+    }
+}
+
+std::string Sha256::hexDigest() {
+    // Padding: 0x80, zeros, then the message length in bits (big-endian)
+    uint64_t bitLength = fTotalLength * 8;
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    uint8_t zero = 0;
+    while (fBufferLength != 56) {
+        update(&zero, 1);
+    }
+    uint8_t lengthBytes[8];
+    for (int i = 0; i < 8; i++) {
+        lengthBytes[i] = static_cast<uint8_t>(bitLength >> (56 - i * 8));
+    }
+    update(lengthBytes, sizeof(lengthBytes));
+
+    static const char* kHex = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(64);
+    for (uint32_t word : fState) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            hex.push_back(kHex[(word >> shift) & 0xf]);
+        }
+    }
+    return hex;
+}
+
+std::string sha256Hex(const std::string& data) {
+    Sha256 hasher;
+    hasher.update(data);
+    return hasher.hexDigest();
+}
@@ -0,0 +1,32 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Incremental SHA-256 (FIPS 180-4), used for content-addressed cache keys
+class Sha256 {
+public:
+    Sha256();
+
+    void update(const void* data, size_t length);
+    void update(const std::string& data) { update(data.data(), data.size()); }
+
+    // Finish hashing and return the digest as 64 lowercase hex characters
+    // The hasher must not be updated after this call
+    std::string hexDigest();
+
+private:
+    void processBlock(const uint8_t* block);
+
+    uint32_t fState[8];
+    uint8_t fBuffer[64];
+    size_t fBufferLength = 0;
+    uint64_t fTotalLength = 0;
+};
+
+// Convenience: SHA-256 of a string as hex
+std::string sha256Hex(const std::string& data);
+
+#endif // SHA256_H
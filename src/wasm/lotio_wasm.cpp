@@ -23,7 +23,9 @@
 #include <map>
 #include <vector>
 #include "include/codec/SkCodec.h"
+#include "include/codec/SkJpegDecoder.h"
 #include "include/codec/SkPngDecoder.h"
+#include "include/codec/SkWebpDecoder.h"
 #include <string>
 #include <memory>
 #include <sstream>
@@ -143,12 +145,24 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
     
     auto layerOverrides = parseLayerOverridesFromString(layer_overrides_json);
     auto imageLayers = parseImageLayersFromString(layer_overrides_json);
+    if (imageLayers.empty() && layerOverrides.empty()) {
+        return;
+    }
+    
+    // Parse the animation once; every override edits this document and it is serialized once at the end
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(json_data);
+    } catch (const nlohmann::json::exception& e) {
+        EM_ASM({
+            console.error('[ERROR] Failed to parse JSON for layer overrides:', UTF8ToString($0));
+        }, e.what());
+        return;
+    }
     
     // Process image layer overrides first
     if (!imageLayers.empty()) {
         try {
-            nlohmann::json j = nlohmann::json::parse(json_data);
-            
             if (j.contains("assets") && j["assets"].is_array()) {
                 // Process each asset
                 for (const auto& [assetId, imageConfig] : imageLayers) {
@@ -228,9 +242,6 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
                         console.log('[DEBUG] Image override applied successfully for asset ID:', UTF8ToString($0));
                     }, assetId.c_str(), dir.c_str(), filename.c_str());
                 }
-                
-                // Serialize back to JSON
-                json_data = j.dump(4);
             } else {
                 EM_ASM({
                     console.warn('[WARNING] Assets array not found in JSON - image overrides will not be applied');
@@ -238,24 +249,20 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
             }
         } catch (const nlohmann::json::exception& e) {
             EM_ASM({
-                console.error('[ERROR] Failed to parse JSON for image asset processing:', UTF8ToString($0));
+                console.error('[ERROR] Failed to apply image asset overrides:', UTF8ToString($0));
             }, e.what());
         }
     }
     
     if (layerOverrides.empty()) {
+        json_data = j.dump();
         return;
     }
     
     // Extract animation width from JSON
     float animationWidth = 720.0f;
-    try {
-        nlohmann::json j = nlohmann::json::parse(json_data);
-        if (j.contains("w") && j["w"].is_number()) {
-            animationWidth = j["w"].get<float>();
-        }
-    } catch (const nlohmann::json::exception&) {
-        // Use default width if parsing fails
+    if (j.contains("w") && j["w"].is_number()) {
+        animationWidth = j["w"].get<float>();
     }
     
     // Use the provided font manager (with registered fonts) for text measurement
@@ -267,6 +274,9 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
         tempFontMgr = emptyMgr.get();
     }
     
+    // Index layers by name once (top-level and precomps)
+    const LayerIndex layers(j);
+    
     // First pass: extract all font info and calculate optimal sizes
     struct LayerModification {
         std::string layerName;
@@ -278,7 +288,7 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
     std::vector<LayerModification> modifications;
     
     for (const auto& [layerName, config] : layerOverrides) {
-        FontInfo fontInfo = extractFontInfoFromJson(json_data, layerName);
+        FontInfo fontInfo = extractFontInfoFromJson(j, layers, layerName);
         
         if (fontInfo.name.empty()) {
             continue;
@@ -338,25 +348,8 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
                                                  fallbackFontInfo.style, fallbackFontInfo.name,
                                                  config.minSize, textToUse, textMeasurementMode);
                 } else {
-                    float min = config.minSize;
-                    float max = config.maxSize;
-                    float bestSize = config.minSize;
-                    
-                    for (int i = 0; i < 10; i++) {
-                        float testSize = (min + max) / 2.0f;
-                        float testWidth = measureTextWidth(tempFontMgr, fallbackFontInfo.family,
-                                                          fallbackFontInfo.style, fallbackFontInfo.name,
-                                                          testSize, textToUse, textMeasurementMode);
-                        
-                        if (testWidth <= paddedTargetWidth) {
-                            bestSize = testSize;
-                            min = testSize;
-                        } else {
-                            max = testSize;
-                        }
-                    }
-                    
-                    optimalSize = std::min(bestSize, config.maxSize);
+                    optimalSize = fitFontSizeFromMinimum(tempFontMgr, fallbackFontInfo, config, textToUse,
+                                                         paddedTargetWidth, fallbackMinWidth, textMeasurementMode);
                     finalWidth = measureTextWidth(tempFontMgr, fallbackFontInfo.family,
                                                  fallbackFontInfo.style, fallbackFontInfo.name,
                                                  optimalSize, textToUse, textMeasurementMode);
@@ -372,14 +365,16 @@ static void processLayerOverridesFromString(std::string& json_data, const std::s
     
     // Second pass: apply modifications
     for (auto it = modifications.rbegin(); it != modifications.rend(); ++it) {
-        modifyTextLayerInJson(json_data, it->layerName, it->textToUse, it->optimalSize);
+        modifyTextLayerInJson(layers, it->layerName, it->textToUse, it->optimalSize);
         
         float widthDiff = it->newTextWidth - it->originalTextWidth;
         if (std::abs(widthDiff) > 0.1f) {
             float adjustment = std::abs(widthDiff);
-            adjustTextAnimatorPosition(json_data, it->layerName, adjustment);
+            adjustTextAnimatorPosition(layers, it->layerName, adjustment);
         }
     }
+    
+    json_data = j.dump();
 }
 
 // Global font manager for creating typefaces from data
@@ -650,7 +645,7 @@ extern "C" {
             g_context->processed_json = std::string(json_data, json_len);
             normalizeLottieTextNewlines(g_context->processed_json);
             
-            // Convert int to enum (0=FAST, 1=ACCURATE, 2=PIXEL_PERFECT)
+            // Convert int to enum (0=FAST, 1=ACCURATE, 2=PIXEL_PERFECT, 3=HYBRID)
             TextMeasurementMode textMeasurementMode = TextMeasurementMode::ACCURATE;  // Default
             if (textMeasurementModeInt == 0) {
                 textMeasurementMode = TextMeasurementMode::FAST;
@@ -658,6 +653,8 @@ extern "C" {
                 textMeasurementMode = TextMeasurementMode::ACCURATE;
             } else if (textMeasurementModeInt == 2) {
                 textMeasurementMode = TextMeasurementMode::PIXEL_PERFECT;
+            } else if (textMeasurementModeInt == 3) {
+                textMeasurementMode = TextMeasurementMode::HYBRID;
             }
             
             if (layer_overrides_json && layer_overrides_len > 0) {
@@ -668,8 +665,10 @@ extern "C" {
             
             // Register codecs needed by SkResources for image decoding
             SkCodecs::Register(SkPngDecoder::Decoder());
+            SkCodecs::Register(SkJpegDecoder::Decoder());
+            SkCodecs::Register(SkWebpDecoder::Decoder());
             EM_ASM({
-                console.log('[DEBUG] Registered image codecs: PNG decoder ready');
+                console.log('[DEBUG] Registered image codecs: PNG, JPEG and WebP decoders ready');
             });
             
             // Resource provider - use DataURI for WASM (handles embedded images)